@@ -16,8 +16,19 @@
 
 #define DISPLAY_INVERTED
 
+#define kAllButtons (TFTWING_BUTTON_UP | TFTWING_BUTTON_DOWN | TFTWING_BUTTON_LEFT | TFTWING_BUTTON_RIGHT | \
+                     TFTWING_BUTTON_SELECT | TFTWING_BUTTON_A | TFTWING_BUTTON_B)
+
 static Adafruit_miniTFTWing ss;
 static bool                 s_state_running = false;
+static uint32_t             s_last_buttons  = kAllButtons;
+
+
+bool any_key_pressed()
+{
+  // buttons read low when pressed
+  return (ss.readButtons() & kAllButtons) != kAllButtons;
+}
 
 
 void setup() 
@@ -25,21 +36,26 @@ void setup()
   randomSeed( analogRead( 0 ) );
 
   Serial.begin(115200);
+  boot_mark( "power on" );
   
   if( !ss.begin() ) 
   {
     Serial.println( "seesaw init error!" );
     while(1);
   }
+  boot_mark( "input" );
 
   ss.tftReset();
   ss.setBacklight( 0x0 ); //set the backlight fully on
 
+  // only the display comes up here, the flash is mounted once the title screen has sat idle for a while
   initialize_graphics();
+  boot_mark( "display" );
   
   Serial.println( "Snake game initialized" );
   
-  draw_intro();
+  draw_intro( any_key_pressed );
+  boot_mark( "playable" );
 }
 
 
@@ -47,11 +63,17 @@ void setup()
 void loop() 
 {
     uint32_t buttons = ss.readButtons();
+    uint32_t pressed = s_last_buttons & ~buttons;   // went low since the last pass
+    s_last_buttons   = buttons;
+
+    if( !s_state_running )
+        service_storage();
 
     if( !s_state_running && !((buttons & TFTWING_BUTTON_A) && (buttons & TFTWING_BUTTON_B) && (buttons & TFTWING_BUTTON_SELECT)) )
     {
         start_game();
         s_state_running = true;
+        return;     // A may have started the game, don't let the same press pause it
     }
 
     if( !s_state_running )
@@ -59,7 +81,8 @@ void loop()
         
     draw_snake();
 
-    if( !(buttons & TFTWING_BUTTON_A) ) 
+    // only on the press, holding A down would keep toggling it
+    if( pressed & TFTWING_BUTTON_A ) 
         pause();
 
 #ifdef DISPLAY_INVERTED
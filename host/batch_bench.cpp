@@ -0,0 +1,194 @@
+//
+//  batch_bench.cpp
+//  
+//
+//  Host only: compares stepping one batch of games against stepping single games in a loop.
+//  The baseline is snake.cpp itself on the emulator with drawing stubbed out, one game at a
+//  time. Then the batch engine plays the same games one instance at a time and all at once,
+//  with the same actions, so those two have to end up with the same scores.
+//    batch_bench [games] [steps]
+//
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+// snake.cpp's pause() would clash with the one in unistd.h
+#define pause game_pause
+#include "snake.cpp"
+#undef pause
+
+#include "snake_batch.h"
+
+
+#define kPolicySeed  2463534242u
+
+static uint32_t s_policy = kPolicySeed;
+
+
+static void choose_actions( uint8_t* actions, uint32_t count )
+{
+    // mostly keep going, turn now and then
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        s_policy ^= s_policy << 13;
+        s_policy ^= s_policy >> 17;
+        s_policy ^= s_policy << 5;
+        actions[i] = (s_policy & 0xF0) ? (uint8_t)kActionNone : (uint8_t)(1 + (s_policy & 3));
+    }
+}
+
+
+static int64_t restart_dead( SnakeBatch* batch, const int16_t* observations )
+{
+    // returns the scores of every game, for the checksum
+    int64_t scores = 0;
+    for( uint32_t i = 0; i < batch->count; i++ )
+    {
+        scores += observations[i * kBatchObservationSize + 6];
+        if( !observations[i * kBatchObservationSize + 7] )
+            batch_reset( batch, i );
+    }
+
+    return scores;
+}
+
+
+static bool play_step( uint8_t action )
+{
+    // one pass of loop() in color-snake.ino as batch_test plays it, false once the game is over
+    if( setjmp( emulator_halt_point() ) )
+        return false;
+
+    draw_snake();
+    switch( action )
+    {
+        case kActionLeft:  move_right(); break;
+        case kActionRight: move_left();  break;
+        case kActionUp:    move_down();  break;
+        case kActionDown:  move_up();    break;
+    }
+    move_snake();
+    return true;
+}
+
+
+static void restart_game()
+{
+    // on the board a game over ends in a reset, here the game's statics go back by hand
+    static const Segment head = { kStartingPointX, kStartingPointY, 0, 1, 0, 0, kStartLength };
+    static const Segment tail = { kStartingPointX, kStartingPointY, 0, 1, 0, 0, 1 };
+
+    snake_draw      = head;
+    snake_erase     = tail;
+    seg_start_x     = kStartingPointX;
+    seg_start_y     = kStartingPointY;
+    s_score         = 0;
+    s_delayTime     = kStartDelay;
+    s_counter       = 0;
+    s_speed         = kStartSpeed;
+    s_speed_frac    = 0;
+    s_tail_moving   = false;
+    s_drawn_x       = kStartingPointX;
+    s_drawn_y       = kStartingPointY;
+    s_segment_count = s_segment_writer = s_segment_reader = 0;
+    start_game();
+}
+
+
+static void play_games( uint32_t games, uint32_t steps )
+{
+    // snake.cpp keeps its game in statics, so it plays games * steps steps of one game,
+    // starting over whenever it ends
+    Serial.set_quiet( true );
+    emulator_stub_drawing( true );
+    randomSeed( 1234 );
+    initialize_graphics();
+    start_game();
+
+    uint8_t action;
+    for( uint64_t step = 0; step < (uint64_t)games * steps; step++ )
+    {
+        choose_actions( &action, 1 );
+        if( !play_step( action ) )
+            restart_game();
+    }
+}
+
+
+static double seconds_since( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+
+int main( int argc, char** argv )
+{
+    uint32_t games = argc > 1 ? atoi( argv[1] ) : 4096;
+    uint32_t steps = argc > 2 ? atoi( argv[2] ) : 2000;
+
+    uint8_t* actions      = (uint8_t*)malloc( games );
+    int16_t* observations = (int16_t*)malloc( games * kBatchObservationSize * sizeof( int16_t ) );
+    int64_t  single_sum   = 0;
+    int64_t  batch_sum    = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    play_games( games, steps );
+    double game_time = seconds_since( start );
+
+    // one game per instance, stepped one after the other, seeded the way batch_create() seeds game i
+    SnakeBatch** singles = (SnakeBatch**)malloc( games * sizeof( SnakeBatch* ) );
+    for( uint32_t i = 0; i < games; i++ )
+        singles[i] = batch_create( 1, 1234 + i * 0x9E3779B9u );
+
+    s_policy = kPolicySeed;
+    start    = std::chrono::steady_clock::now();
+    for( uint32_t step = 0; step < steps; step++ )
+    {
+        choose_actions( actions, games );
+        for( uint32_t i = 0; i < games; i++ )
+        {
+            int16_t* obs = observations + i * kBatchObservationSize;
+            batch_step( singles[i], &actions[i], obs );
+            single_sum += restart_dead( singles[i], obs );
+        }
+    }
+    double single_time = seconds_since( start );
+
+    for( uint32_t i = 0; i < games; i++ )
+        batch_destroy( singles[i] );
+    free( singles );
+
+    // all of them in lockstep, with the same actions
+    SnakeBatch* batch = batch_create( games, 1234 );
+    s_policy = kPolicySeed;
+
+    start = std::chrono::steady_clock::now();
+    for( uint32_t step = 0; step < steps; step++ )
+    {
+        choose_actions( actions, games );
+        batch_step( batch, actions, observations );
+        batch_sum += restart_dead( batch, observations );
+    }
+    double batch_time = seconds_since( start );
+
+    batch_destroy( batch );
+    free( actions );
+    free( observations );
+
+    double total = (double)games * steps;
+    printf( "games: %u, steps: %u (checksum %lld)\n", games, steps, (long long)batch_sum );
+    printf( "snake.cpp: %12.0f game-steps/sec\n", total / game_time );
+    printf( "single:    %12.0f game-steps/sec (%.1fx)\n", total / single_time, game_time / single_time );
+    printf( "batch:     %12.0f game-steps/sec (%.1fx)\n", total / batch_time, game_time / batch_time );
+    if( single_sum != batch_sum )
+    {
+        printf( "the single games scored %lld, they don't match the batch\n", (long long)single_sum );
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// EOF
@@ -0,0 +1,305 @@
+//
+//  batch_test.cpp
+//
+//
+//  Host only: plays the same games through snake.cpp on the panel emulator and through the
+//  batched engine, and fails on the first step where the two disagree. snake.cpp keeps its
+//  game in statics, so it is built into this file and every game runs in its own process.
+//  Build it with -DCELL_GRID to check the cell mode. It also checks that both turn away the
+//  same levels, ones too big for coord_t or with tiles that aren't whole cells.
+//    batch_test [-l level_file] [-g games] [-s steps]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// snake.cpp's pause() would clash with the one in unistd.h
+#define pause game_pause
+#include "snake.cpp"
+#undef pause
+
+#include "snake_batch.h"
+
+
+typedef struct
+{
+    uint32_t steps;
+    int16_t  score;
+    bool     agreed;
+} GameResult;
+
+
+static std::vector<uint8_t> s_level_data;
+
+
+#define kLookAhead  (8 / kCellSize)        // how far ahead the policy looks for walls
+
+static bool danger( SnakeBatch* batch, int16_t dir_x, int16_t dir_y )
+{
+    int16_t x = batch->head_x[0] + dir_x * kLookAhead;
+    int16_t y = batch->head_y[0] + dir_y * kLookAhead;
+    if( x < 0 || y < 0 || x >= batch->board_width || y >= batch->board_height )
+        return true;
+
+    return batch->blocked && batch->blocked[y * batch->board_width + x];
+}
+
+
+static uint8_t choose_action( SnakeBatch* batch, uint32_t* policy )
+{
+    // head for the apple along the longer way round, with the odd random turn to keep it honest
+    *policy ^= *policy << 13;
+    *policy ^= *policy >> 17;
+    *policy ^= *policy << 5;
+    if( !(*policy & 63) )
+        return (uint8_t)(kActionLeft + ((*policy >> 3) & 3));
+
+    // and turn away from walls coming up, so the games get long enough for the speed to change
+    int16_t dir_x = batch->head_dir_x[0];
+    int16_t dir_y = batch->head_dir_y[0];
+    if( danger( batch, dir_x, dir_y ) )
+    {
+        if( dir_x )
+            return danger( batch, 0, -1 ) ? kActionDown : kActionUp;
+        return danger( batch, -1, 0 ) ? kActionRight : kActionLeft;
+    }
+
+    // otherwise keep going until the apple is level with the head, then turn towards it
+    int16_t dx = batch->apple_x[0] - batch->head_x[0];
+    int16_t dy = batch->apple_y[0] - batch->head_y[0];
+    if( dir_x && dx * dir_x <= 0 && dy )
+        return dy < 0 ? kActionUp : kActionDown;
+    if( dir_y && dy * dir_y <= 0 && dx )
+        return dx < 0 ? kActionLeft : kActionRight;
+    return kActionNone;
+}
+
+
+static bool play_step( uint8_t action )
+{
+    // one pass of loop() in color-snake.ino, false once the game is over.
+    // The batch's directions are the screen's, the game's buttons are mirrored
+    if( setjmp( emulator_halt_point() ) )
+        return false;
+
+    draw_snake();
+    switch( action )
+    {
+        case kActionLeft:  move_right(); break;
+        case kActionRight: move_left();  break;
+        case kActionUp:    move_down();  break;
+        case kActionDown:  move_up();    break;
+    }
+    move_snake();
+    return true;
+}
+
+
+#define AGREE( field, game_value, batch_value ) \
+    if( (game_value) != (batch_value) ) { printf( "seed %u step %u: %s is %d in the game, %d in the batch\n", seed, step, field, (int)(game_value), (int)(batch_value) ); return false; }
+
+static bool compare( uint32_t seed, uint32_t step, SnakeBatch* batch, bool running )
+{
+    AGREE( "alive",   running,           batch->alive[0] );
+    AGREE( "head x",  snake_draw.x,      batch->head_x[0] );
+    AGREE( "head y",  snake_draw.y,      batch->head_y[0] );
+    AGREE( "dir x",   snake_draw.dir_x,  batch->head_dir_x[0] );
+    AGREE( "dir y",   snake_draw.dir_y,  batch->head_dir_y[0] );
+    AGREE( "length",  snake_draw.length, batch->length[0] );
+    AGREE( "delay",   s_delayTime,       batch->delay[0] );
+    AGREE( "speed",   s_speed,           batch->speed[0] );
+    AGREE( "score",   s_score,           batch->score[0] );
+    AGREE( "apple x", apple_x,           batch->apple_x[0] );
+    AGREE( "apple y", apple_y,           batch->apple_y[0] );
+    if( !running )
+        return true;
+
+    // the tail and the view don't matter once the game has stopped
+    AGREE( "tail x",  snake_erase.x,     batch->tail_x[0] );
+    AGREE( "tail y",  snake_erase.y,     batch->tail_y[0] );
+    AGREE( "turns",   s_segment_count,   batch->seg_count[0] );
+    AGREE( "view x",  s_view_col,        batch->view_col[0] );
+    AGREE( "view y",  s_view_row,        batch->view_row[0] );
+    return true;
+}
+
+
+static std::vector<uint8_t> make_level( uint8_t tile, uint16_t width, uint16_t height )
+{
+    // an empty level: the header, the row offsets, then every row as the same floor runs
+    std::vector<uint8_t> runs;
+    for( uint16_t left = width; left; )
+    {
+        uint16_t count = left < 128 ? left : 128;
+        runs.push_back( (uint8_t)(count - 1) );
+        left -= count;
+    }
+
+    uint8_t header[kLevelHeaderSize] = { 'S', 'L', 1, tile, (uint8_t)width, (uint8_t)(width >> 8), (uint8_t)height, (uint8_t)(height >> 8) };
+    std::vector<uint8_t> level( header, header + kLevelHeaderSize );
+    for( uint16_t row = 0; row < height; row++ )
+    {
+        uint16_t offset = kLevelHeaderSize + height * 2 + row * runs.size();
+        level.push_back( (uint8_t)offset );
+        level.push_back( (uint8_t)(offset >> 8) );
+    }
+    for( uint16_t row = 0; row < height; row++ )
+        level.insert( level.end(), runs.begin(), runs.end() );
+    return level;
+}
+
+
+static bool check_level_limits()
+{
+    typedef struct
+    {
+        uint8_t  tile;
+        uint16_t width;
+        uint16_t height;
+        bool     fits;      // in this build's mode
+    } LevelCase;
+
+    static const LevelCase kCases[] =
+    {
+        { 4,   20,  10, true },
+        { 4,  127, 127, true },
+        { 4,  130,  10, kCellSize == 1 },  // past int8_t in cells
+        { 4,   10, 130, kCellSize == 1 },
+        { 6,   20,  10, kCellSize == 1 },  // tiles of a cell and a half
+        { 4, 8200,   1, false },           // past int16_t in pixels
+    };
+
+    Serial.set_quiet( true );
+    initialize_graphics();
+
+    bool ok = true;
+    for( size_t i = 0; i < sizeof( kCases ) / sizeof( kCases[0] ); i++ )
+    {
+        const LevelCase&     test  = kCases[i];
+        std::vector<uint8_t> level = make_level( test.tile, test.width, test.height );
+        emulator_write_file( "level9", level.data(), level.size() );
+
+        SnakeBatch* batch    = batch_create( 1, 1 );
+        bool        in_batch = batch_load_level( batch, level.data(), level.size() );
+        bool        in_game  = load_level( 9 );
+        batch_destroy( batch );
+        if( in_batch != test.fits || in_game != test.fits )
+        {
+            printf( "a %ux%u level of %u pixel tiles should%s load, the game says %d and the batch %d\n",
+                    test.width, test.height, test.tile, test.fits ? "" : "n't", in_game, in_batch );
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+static GameResult play_game( uint32_t seed, uint32_t steps )
+{
+    GameResult result = { 0, 0, true };
+    Serial.set_quiet( true );
+
+    SnakeBatch* batch = batch_create( 1, seed );
+    if( !s_level_data.empty() && !batch_load_level( batch, s_level_data.data(), s_level_data.size() ) )
+    {
+        printf( "the batch can't read the level\n" );
+        result.agreed = false;
+        return result;
+    }
+
+    // both draw the first apple from the same stream
+    batch->rng[0] = seed | 1;
+    batch_reset( batch, 0 );
+    randomSeed( seed );
+    initialize_graphics();
+    start_game();
+
+    // every other game starts with the delay run down, so apples speed the snake up
+    if( seed & 1 )
+    {
+        s_delayTime      = kMinDelay;
+        batch->delay[0] = kMinDelay;
+    }
+
+    uint32_t policy = seed * 2654435761u | 1;
+    int16_t  observations[kBatchObservationSize];
+    bool     running = true;
+    result.agreed = compare( seed, 0, batch, running );
+    while( result.agreed && running && result.steps < steps )
+    {
+        uint8_t action = choose_action( batch, &policy );
+        running = play_step( action );
+        batch_step( batch, &action, observations );
+        ++result.steps;
+        result.agreed = compare( seed, result.steps, batch, running );
+    }
+
+    result.score = s_score;
+    batch_destroy( batch );
+    return result;
+}
+
+
+int main( int argc, char** argv )
+{
+    uint32_t games = 100;
+    uint32_t steps = 5000;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( !strcmp( argv[i], "-g" ) && i + 1 < argc )
+            games = atoi( argv[++i] );
+        else if( !strcmp( argv[i], "-s" ) && i + 1 < argc )
+            steps = atoi( argv[++i] );
+        else if( !strcmp( argv[i], "-l" ) && i + 1 < argc && !emulator_load_file( "level1", argv[++i], &s_level_data ) )
+        {
+            fprintf( stderr, "can't read %s\n", argv[i] );
+            return 1;
+        }
+    }
+
+    if( !check_level_limits() )
+        return 1;
+
+    uint64_t total_steps = 0;
+    int16_t  best        = 0;
+    uint32_t failures    = 0;
+    for( uint32_t game = 0; game < games; game++ )
+    {
+        int channel[2];
+        if( pipe( channel ) )
+            return 1;
+
+        fflush( stdout );
+        pid_t child = fork();
+        if( !child )
+        {
+            GameResult result = play_game( 1 + game, steps );
+            fflush( stdout );
+            ssize_t written = write( channel[1], &result, sizeof( result ) );
+            _exit( written == sizeof( result ) ? 0 : 1 );
+        }
+
+        GameResult result = { 0, 0, false };
+        close( channel[1] );
+        if( read( channel[0], &result, sizeof( result ) ) != sizeof( result ) )
+            printf( "game %u didn't finish\n", game );
+        close( channel[0] );
+        waitpid( child, NULL, 0 );
+
+        failures    += !result.agreed;
+        total_steps += result.steps;
+        best         = max( best, result.score );
+    }
+
+    printf( "%u games, %llu steps, best score %d: %s\n", games, (unsigned long long)total_steps, best,
+            failures ? "the batch disagrees with snake.cpp" : "the batch agrees with snake.cpp" );
+    return failures ? 1 : 0;
+}
+
+
+// EOF
@@ -0,0 +1,317 @@
+//
+//  Adafruit_GFX.cpp
+//  
+//
+
+#include "Adafruit_GFX.h"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the classic 5x7 font from glcdfont.c, printable ASCII only (anything else draws nothing)
+static const uint8_t s_font[][5] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, // ' ' ! "
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // # $ %
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 }, // & ' (
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ) * +
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 }, // , - .
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // / 0 1
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 }, // 2 3 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 }, // 5 6 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 }, // 8 9 :
+    { 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // ; < =
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, // > ? @
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // A B C
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, // D E F
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // G H I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 }, // J K L
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // M N O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, // P Q R
+    { 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // S T U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 }, // V W X
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 }, // Y Z [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, // \ ] ^
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 }, // _ ` a
+    { 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, { 0x38, 0x44, 0x44, 0x28, 0x7F }, // b c d
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 }, // e f g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 }, // h i j
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 }, // k l m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0xFC, 0x18, 0x24, 0x24, 0x18 }, // n o p
+    { 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 }, // q r s
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, // t u v
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C }, // w x y
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x77, 0x00, 0x00 }, // z { |
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 },                                   // } ~
+};
+
+#define kFirstGlyph  ' '
+#define kLastGlyph   '~'
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Adafruit_GFX::Adafruit_GFX( int16_t w, int16_t h ) : WIDTH( w ), HEIGHT( h )
+{
+    m_width      = w;
+    m_height     = h;
+    m_cursor_x   = 0;
+    m_cursor_y   = 0;
+    m_text_color = 0xFFFF;
+    m_text_bg    = 0xFFFF;
+    m_text_size  = 1;
+    m_rotation   = 0;
+    m_wrap       = true;
+}
+
+
+void Adafruit_GFX::writeFillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+    fillRect( x, y, w, h, color );
+}
+
+
+void Adafruit_GFX::writeFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color )
+{
+    drawFastVLine( x, y, h, color );
+}
+
+
+void Adafruit_GFX::writeFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color )
+{
+    drawFastHLine( x, y, w, color );
+}
+
+
+void Adafruit_GFX::writeLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color )
+{
+    // Bresenham, one pixel at a time
+    bool steep = abs( y1 - y0 ) > abs( x1 - x0 );
+    if( steep )
+    {
+        std::swap( x0, y0 );
+        std::swap( x1, y1 );
+    }
+    if( x0 > x1 )
+    {
+        std::swap( x0, x1 );
+        std::swap( y0, y1 );
+    }
+
+    int16_t dx    = x1 - x0;
+    int16_t dy    = abs( y1 - y0 );
+    int16_t err   = dx / 2;
+    int16_t ystep = y0 < y1 ? 1 : -1;
+
+    for( ; x0 <= x1; x0++ )
+    {
+        if( steep )
+            writePixel( y0, x0, color );
+        else
+            writePixel( x0, y0, color );
+
+        err -= dy;
+        if( err < 0 )
+        {
+            y0  += ystep;
+            err += dx;
+        }
+    }
+}
+
+
+void Adafruit_GFX::drawPixel( int16_t x, int16_t y, uint16_t color )
+{
+    startWrite();
+    writePixel( x, y, color );
+    endWrite();
+}
+
+
+void Adafruit_GFX::drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color )
+{
+    startWrite();
+    writeLine( x, y, x, y + h - 1, color );
+    endWrite();
+}
+
+
+void Adafruit_GFX::drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color )
+{
+    startWrite();
+    writeLine( x, y, x + w - 1, y, color );
+    endWrite();
+}
+
+
+void Adafruit_GFX::fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+    startWrite();
+    for( int16_t i = x; i < x + w; i++ )
+        writeFastVLine( i, y, h, color );
+    endWrite();
+}
+
+
+void Adafruit_GFX::fillScreen( uint16_t color )
+{
+    fillRect( 0, 0, m_width, m_height, color );
+}
+
+
+void Adafruit_GFX::drawLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color )
+{
+    if( x0 == x1 )
+    {
+        if( y0 > y1 )
+            std::swap( y0, y1 );
+        drawFastVLine( x0, y0, y1 - y0 + 1, color );
+    }
+    else if( y0 == y1 )
+    {
+        if( x0 > x1 )
+            std::swap( x0, x1 );
+        drawFastHLine( x0, y0, x1 - x0 + 1, color );
+    }
+    else
+    {
+        startWrite();
+        writeLine( x0, y0, x1, y1, color );
+        endWrite();
+    }
+}
+
+
+void Adafruit_GFX::setRotation( uint8_t r )
+{
+    m_rotation = r & 3;
+    m_width    = (m_rotation & 1) ? HEIGHT : WIDTH;
+    m_height   = (m_rotation & 1) ? WIDTH : HEIGHT;
+}
+
+
+#pragma mark -
+
+void Adafruit_GFX::fillCircle( int16_t x0, int16_t y0, int16_t r, uint16_t color )
+{
+    startWrite();
+    writeFastVLine( x0, y0 - r, 2 * r + 1, color );
+    fillCircleHelper( x0, y0, r, 3, 0, color );
+    endWrite();
+}
+
+
+void Adafruit_GFX::fillCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color )
+{
+    int16_t f     = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x     = 0;
+    int16_t y     = r;
+    int16_t px    = x;
+    int16_t py    = y;
+
+    delta++; // avoid some +1's in the loop
+
+    while( x < y )
+    {
+        if( f >= 0 )
+        {
+            y--;
+            ddF_y += 2;
+            f     += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f     += ddF_x;
+
+        // only draw the columns we haven't drawn yet
+        if( x < (y + 1) )
+        {
+            if( corners & 1 )
+                writeFastVLine( x0 + x, y0 - y, 2 * y + delta, color );
+            if( corners & 2 )
+                writeFastVLine( x0 - x, y0 - y, 2 * y + delta, color );
+        }
+        if( y != py )
+        {
+            if( corners & 1 )
+                writeFastVLine( x0 + py, y0 - px, 2 * px + delta, color );
+            if( corners & 2 )
+                writeFastVLine( x0 - py, y0 - px, 2 * px + delta, color );
+            py = y;
+        }
+        px = x;
+    }
+}
+
+
+#pragma mark -
+
+void Adafruit_GFX::drawChar( int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size )
+{
+    if( x >= m_width || y >= m_height || (x + 6 * size - 1) < 0 || (y + 8 * size - 1) < 0 )
+        return;
+
+    const uint8_t* glyph = (c >= kFirstGlyph && c <= kLastGlyph) ? s_font[c - kFirstGlyph] : s_font[0];
+
+    startWrite();
+    for( int8_t i = 0; i < 5; i++ )
+    {
+        uint8_t line = glyph[i];
+        for( int8_t j = 0; j < 8; j++, line >>= 1 )
+        {
+            if( line & 1 )
+            {
+                if( size == 1 )
+                    writePixel( x + i, y + j, color );
+                else
+                    writeFillRect( x + i * size, y + j * size, size, size, color );
+            }
+            else if( bg != color )
+            {
+                if( size == 1 )
+                    writePixel( x + i, y + j, bg );
+                else
+                    writeFillRect( x + i * size, y + j * size, size, size, bg );
+            }
+        }
+    }
+
+    // the gap to the next character
+    if( bg != color )
+    {
+        if( size == 1 )
+            writeFastVLine( x + 5, y, 8, bg );
+        else
+            writeFillRect( x + 5 * size, y, size, 8 * size, bg );
+    }
+    endWrite();
+}
+
+
+size_t Adafruit_GFX::write( uint8_t c )
+{
+    if( c == '\n' )
+    {
+        m_cursor_x  = 0;
+        m_cursor_y += m_text_size * 8;
+    }
+    else if( c != '\r' )
+    {
+        if( m_wrap && (m_cursor_x + m_text_size * 6) > m_width )
+        {
+            m_cursor_x  = 0;
+            m_cursor_y += m_text_size * 8;
+        }
+        drawChar( m_cursor_x, m_cursor_y, c, m_text_color, m_text_bg, m_text_size );
+        m_cursor_x += m_text_size * 6;
+    }
+
+    return 1;
+}
+
+
+// EOF
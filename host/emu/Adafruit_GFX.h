@@ -0,0 +1,71 @@
+//
+//  Adafruit_GFX.h
+//  
+//
+//  Host only: the parts of Adafruit_GFX that snake.cpp uses, with the same drawing algorithms
+//  and the same startWrite()/write*()/endWrite() structure so the panel sees the same traffic.
+//
+
+#ifndef Adafruit_GFX_h
+#define Adafruit_GFX_h
+
+#include "Arduino.h"
+
+
+class Adafruit_GFX : public Print
+{
+public:
+    Adafruit_GFX( int16_t w, int16_t h );
+
+    // the device has to provide these
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writePixel( int16_t x, int16_t y, uint16_t color ) = 0;
+    virtual void writeFillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    virtual void writeFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color );
+    virtual void writeFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color );
+    virtual void writeLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color );
+
+    virtual void drawPixel( int16_t x, int16_t y, uint16_t color );
+    virtual void drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color );
+    virtual void drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color );
+    virtual void fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    virtual void fillScreen( uint16_t color );
+    virtual void drawLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color );
+    virtual void setRotation( uint8_t r );
+    virtual void invertDisplay( bool ) {}
+
+    void fillCircle( int16_t x0, int16_t y0, int16_t r, uint16_t color );
+    void fillCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color );
+    void drawChar( int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size );
+
+    void setCursor( int16_t x, int16_t y )        { m_cursor_x = x; m_cursor_y = y; }
+    void setTextColor( uint16_t c )               { m_text_color = m_text_bg = c; }
+    void setTextColor( uint16_t c, uint16_t bg )  { m_text_color = c; m_text_bg = bg; }
+    void setTextSize( uint8_t s )                 { m_text_size = s > 0 ? s : 1; }
+    void setTextWrap( bool w )                    { m_wrap = w; }
+
+    virtual size_t write( uint8_t c );
+
+    int16_t width() const    { return m_width; }
+    int16_t height() const   { return m_height; }
+    uint8_t getRotation() const { return m_rotation; }
+    int16_t getCursorX() const  { return m_cursor_x; }
+    int16_t getCursorY() const  { return m_cursor_y; }
+
+protected:
+    int16_t  WIDTH;           // before rotation
+    int16_t  HEIGHT;
+    int16_t  m_width;
+    int16_t  m_height;
+    int16_t  m_cursor_x;
+    int16_t  m_cursor_y;
+    uint16_t m_text_color;
+    uint16_t m_text_bg;
+    uint8_t  m_text_size;
+    uint8_t  m_rotation;
+    bool     m_wrap;
+};
+
+
+#endif /* Adafruit_GFX_h */
@@ -0,0 +1,33 @@
+//
+//  Adafruit_QSPI_GD25Q.h
+//  
+//
+//  Host only: the QSPI flash as a block of memory, erased to 0xFF.
+//
+
+#ifndef Adafruit_QSPI_GD25Q_h
+#define Adafruit_QSPI_GD25Q_h
+
+#include "Arduino.h"
+
+
+#define SPIFLASHTYPE_W25Q16BV  0
+#define kEmulatorFlashSize     (2 * 1024 * 1024)
+
+
+class Adafruit_QSPI_GD25Q
+{
+public:
+    bool     begin()                          { return true; }
+    void     setFlashType( uint8_t )          {}
+    bool     readMemory( uint32_t addr, uint8_t* data, uint32_t size );
+    bool     writeMemory( uint32_t addr, uint8_t* data, uint32_t size );
+    bool     chipErase();
+};
+
+
+// the flash contents, for seeding levels from a harness
+uint8_t* emulator_flash();
+
+
+#endif /* Adafruit_QSPI_GD25Q_h */
@@ -0,0 +1,136 @@
+//
+//  Adafruit_SPIFlash_FatFs.cpp
+//  
+//
+
+#include "Adafruit_SPIFlash_FatFs.h"
+#include "Adafruit_QSPI_GD25Q.h"
+
+#include <map>
+#include <stdio.h>
+#include <string>
+
+
+static std::map<std::string, std::vector<uint8_t> > s_files;
+static std::vector<uint8_t>                          s_flash( kEmulatorFlashSize, 0xFF );
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool File::seek( uint32_t position )
+{
+    if( !m_data || position > m_data->size() )
+        return false;
+
+    m_position = position;
+    return true;
+}
+
+
+int File::read( void* buffer, uint16_t size )
+{
+    if( !m_data )
+        return -1;
+
+    uint32_t count = min( (uint32_t)size, (uint32_t)(m_data->size() - m_position) );
+    memcpy( buffer, m_data->data() + m_position, count );
+    m_position += count;
+    return count;
+}
+
+
+size_t File::write( const uint8_t* buffer, size_t size )
+{
+    if( !m_data )
+        return 0;
+
+    if( m_position + size > m_data->size() )
+        m_data->resize( m_position + size );
+
+    memcpy( m_data->data() + m_position, buffer, size );
+    m_position += size;
+    return size;
+}
+
+
+File Adafruit_W25Q16BV_FatFs::open( const char* name, uint8_t mode )
+{
+    std::map<std::string, std::vector<uint8_t> >::iterator file = s_files.find( name );
+    if( file != s_files.end() )
+        return File( &file->second );
+
+    if( mode != FILE_WRITE )
+        return File();
+
+    return File( &s_files[name] );
+}
+
+
+void emulator_write_file( const char* name, const uint8_t* data, size_t size )
+{
+    s_files[name].assign( data, data + size );
+}
+
+
+bool emulator_load_file( const char* name, const char* path, std::vector<uint8_t>* data )
+{
+    FILE* file = fopen( path, "rb" );
+    if( !file )
+        return false;
+
+    std::vector<uint8_t>& contents = s_files[name];
+    uint8_t buffer[256];
+    size_t  count;
+    contents.clear();
+    while( (count = fread( buffer, 1, sizeof( buffer ), file )) > 0 )
+        contents.insert( contents.end(), buffer, buffer + count );
+    fclose( file );
+
+    if( data )
+        *data = contents;
+    return true;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Adafruit_QSPI_GD25Q::readMemory( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    if( addr + size > s_flash.size() )
+        return false;
+
+    memcpy( data, &s_flash[addr], size );
+    return true;
+}
+
+
+bool Adafruit_QSPI_GD25Q::writeMemory( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    if( addr + size > s_flash.size() )
+        return false;
+
+    // programming can only clear bits
+    for( uint32_t i = 0; i < size; i++ )
+        s_flash[addr + i] &= data[i];
+    return true;
+}
+
+
+bool Adafruit_QSPI_GD25Q::chipErase()
+{
+    std::fill( s_flash.begin(), s_flash.end(), 0xFF );
+    return true;
+}
+
+
+uint8_t* emulator_flash()
+{
+    return s_flash.data();
+}
+
+
+// EOF
@@ -0,0 +1,62 @@
+//
+//  Adafruit_SPIFlash_FatFs.h
+//  
+//
+//  Host only: FatFs on the flash as named in-memory files.
+//
+
+#ifndef Adafruit_SPIFlash_FatFs_h
+#define Adafruit_SPIFlash_FatFs_h
+
+#include "Arduino.h"
+
+#include <vector>
+
+
+#define FILE_READ   0x01
+#define FILE_WRITE  0x13
+
+
+class File
+{
+public:
+    File() : m_data( NULL ), m_position( 0 ) {}
+    explicit File( std::vector<uint8_t>* data ) : m_data( data ), m_position( 0 ) {}
+
+    operator bool() const             { return m_data != NULL; }
+
+    bool     seek( uint32_t position );
+    uint32_t position() const         { return m_position; }
+    uint32_t size() const             { return m_data ? m_data->size() : 0; }
+    int      read( void* buffer, uint16_t size );
+    size_t   write( uint8_t value )   { return write( &value, 1 ); }
+    size_t   write( const uint8_t* buffer, size_t size );
+    void     flush()                  {}
+    void     close()                  { m_data = NULL; }
+
+private:
+    std::vector<uint8_t>* m_data;
+    uint32_t              m_position;
+};
+
+
+class Adafruit_W25Q16BV_FatFs
+{
+public:
+    template <typename Flash>
+    explicit Adafruit_W25Q16BV_FatFs( Flash& ) {}
+
+    bool     begin()                  { return true; }
+    bool     activate()               { return true; }
+    File     open( const char* name, uint8_t mode = FILE_READ );
+};
+
+
+// put a file on the emulated volume, for seeding levels from a harness
+void emulator_write_file( const char* name, const uint8_t* data, size_t size );
+
+// same with the contents of a file on the host, data gets a copy if it's given
+bool emulator_load_file( const char* name, const char* path, std::vector<uint8_t>* data = NULL );
+
+
+#endif /* Adafruit_SPIFlash_FatFs_h */
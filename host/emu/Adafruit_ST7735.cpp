@@ -0,0 +1,344 @@
+//
+//  Adafruit_ST7735.cpp
+//  
+//
+
+#include "Adafruit_ST7735.h"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ST7735_FRMCTR1  0xB1
+#define ST7735_FRMCTR2  0xB2
+#define ST7735_FRMCTR3  0xB3
+#define ST7735_INVCTR   0xB4
+#define ST7735_PWCTR1   0xC0
+#define ST7735_PWCTR2   0xC1
+#define ST7735_PWCTR3   0xC2
+#define ST7735_PWCTR4   0xC3
+#define ST7735_PWCTR5   0xC4
+#define ST7735_VMCTR1   0xC5
+#define ST7735_GMCTRP1  0xE0
+#define ST7735_GMCTRN1  0xE1
+
+#define ST_CMD_DELAY    0x80    // a delay in ms follows the arguments, 255 means 500
+
+
+// same shape as the init lists in Adafruit_ST7735.cpp: count, then command, args | delay flag, args, delay
+static const uint8_t Rcmd1[] =
+{
+    15,
+    ST77XX_SWRESET, ST_CMD_DELAY, 150,
+    ST77XX_SLPOUT,  ST_CMD_DELAY, 255,
+    ST7735_FRMCTR1, 3, 0x01, 0x2C, 0x2D,
+    ST7735_FRMCTR2, 3, 0x01, 0x2C, 0x2D,
+    ST7735_FRMCTR3, 6, 0x01, 0x2C, 0x2D, 0x01, 0x2C, 0x2D,
+    ST7735_INVCTR,  1, 0x07,
+    ST7735_PWCTR1,  3, 0xA2, 0x02, 0x84,
+    ST7735_PWCTR2,  1, 0xC5,
+    ST7735_PWCTR3,  2, 0x0A, 0x00,
+    ST7735_PWCTR4,  2, 0x8A, 0x2A,
+    ST7735_PWCTR5,  2, 0x8A, 0xEE,
+    ST7735_VMCTR1,  1, 0x0E,
+    ST77XX_INVOFF,  0,
+    ST77XX_MADCTL,  1, 0xC8,
+    ST77XX_COLMOD,  1, 0x05
+};
+
+static const uint8_t Rcmd2green160x80[] =
+{
+    2,
+    ST77XX_CASET, 4, 0x00, 0x00, 0x00, 0x4F,
+    ST77XX_RASET, 4, 0x00, 0x00, 0x00, 0x9F
+};
+
+static const uint8_t Rcmd3[] =
+{
+    4,
+    ST7735_GMCTRP1, 16, 0x02, 0x1C, 0x07, 0x12, 0x37, 0x32, 0x29, 0x2D, 0x29, 0x25, 0x2B, 0x39, 0x00, 0x01, 0x03, 0x10,
+    ST7735_GMCTRN1, 16, 0x03, 0x1D, 0x07, 0x06, 0x2E, 0x2C, 0x29, 0x2D, 0x2E, 0x2E, 0x37, 0x3F, 0x00, 0x00, 0x02, 0x10,
+    ST77XX_NORON,   ST_CMD_DELAY, 10,
+    ST77XX_DISPON,  ST_CMD_DELAY, 100
+};
+
+
+static St7735Emu s_panel;
+static bool      s_stubbed = false;
+
+
+St7735Emu* emulator_panel()
+{
+    return &s_panel;
+}
+
+
+void emulator_stub_drawing( bool stub )
+{
+    s_stubbed = stub;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Adafruit_ST7735::Adafruit_ST7735( int8_t, int8_t, int8_t ) : Adafruit_GFX( 128, 160 )
+{
+    m_tab      = INITR_GREENTAB;
+    m_colstart = 0;
+    m_rowstart = 0;
+    m_xstart   = 0;
+    m_ystart   = 0;
+}
+
+
+void Adafruit_ST7735::displayInit( const uint8_t* list )
+{
+    uint8_t commands = *list++;
+    while( commands-- )
+    {
+        uint8_t command = *list++;
+        uint8_t args    = *list++;
+        uint8_t count   = args & ~ST_CMD_DELAY;
+        sendCommand( command, list, count );
+        list += count;
+
+        if( args & ST_CMD_DELAY )
+        {
+            uint16_t ms = *list++;
+            delay( ms == 255 ? 500 : ms );
+        }
+    }
+}
+
+
+void Adafruit_ST7735::initR( uint8_t options )
+{
+    displayInit( Rcmd1 );
+    if( options == INITR_MINI160x80 )
+    {
+        WIDTH      = m_width  = ST7735_TFTWIDTH_80;
+        HEIGHT     = m_height = ST7735_TFTHEIGHT_160;
+        displayInit( Rcmd2green160x80 );
+        m_colstart = 24;
+        m_rowstart = 0;
+    }
+    displayInit( Rcmd3 );
+
+    if( options == INITR_BLACKTAB || options == INITR_MINI160x80 )
+    {
+        uint8_t madctl = 0xC0;
+        sendCommand( ST77XX_MADCTL, &madctl, 1 );
+    }
+
+    m_tab = options;
+    setRotation( 0 );
+}
+
+
+void Adafruit_ST7735::setRotation( uint8_t r )
+{
+    Adafruit_GFX::setRotation( r );
+
+    // the black tab and mini panels are RGB, everything else BGR
+    uint8_t rgb    = (m_tab == INITR_BLACKTAB || m_tab == INITR_MINI160x80) ? ST77XX_MADCTL_RGB : 0x08;
+    uint8_t madctl = 0;
+    switch( m_rotation )
+    {
+        case 0: madctl = ST77XX_MADCTL_MX | ST77XX_MADCTL_MY | rgb; break;
+        case 1: madctl = ST77XX_MADCTL_MY | ST77XX_MADCTL_MV | rgb; break;
+        case 2: madctl = rgb;                                       break;
+        case 3: madctl = ST77XX_MADCTL_MX | ST77XX_MADCTL_MV | rgb; break;
+    }
+
+    m_xstart = (m_rotation & 1) ? m_rowstart : m_colstart;
+    m_ystart = (m_rotation & 1) ? m_colstart : m_rowstart;
+    sendCommand( ST77XX_MADCTL, &madctl, 1 );
+}
+
+
+void Adafruit_ST7735::invertDisplay( bool i )
+{
+    sendCommand( i ? ST77XX_INVON : ST77XX_INVOFF );
+}
+
+
+void Adafruit_ST7735::sendCommand( uint8_t command, const uint8_t* data, uint8_t count )
+{
+    startWrite();
+    writeCommand( command );
+    for( uint8_t i = 0; i < count; i++ )
+        s_panel.data( data[i] );
+    endWrite();
+}
+
+
+void Adafruit_ST7735::writeCommand( uint8_t command )
+{
+    s_panel.command( command );
+}
+
+
+void Adafruit_ST7735::setAddrWindow( uint16_t x, uint16_t y, uint16_t w, uint16_t h )
+{
+    x += m_xstart;
+    y += m_ystart;
+
+    writeCommand( ST77XX_CASET );
+    s_panel.data16( x, 1 );
+    s_panel.data16( x + w - 1, 1 );
+    writeCommand( ST77XX_RASET );
+    s_panel.data16( y, 1 );
+    s_panel.data16( y + h - 1, 1 );
+    writeCommand( ST77XX_RAMWR );
+}
+
+
+#pragma mark -
+
+void Adafruit_ST7735::startWrite()
+{
+    if( s_stubbed )
+        return;
+
+    s_panel.begin();
+}
+
+
+void Adafruit_ST7735::endWrite()
+{
+    if( s_stubbed )
+        return;
+
+    s_panel.end();
+}
+
+
+void Adafruit_ST7735::writePixel( int16_t x, int16_t y, uint16_t color )
+{
+    if( s_stubbed )
+        return;
+
+    if( x < 0 || y < 0 || x >= m_width || y >= m_height )
+        return;
+
+    setAddrWindow( x, y, 1, 1 );
+    s_panel.data16( color, 1 );
+}
+
+
+static bool clip( int16_t& x, int16_t& y, int16_t& w, int16_t& h, int16_t width, int16_t height )
+{
+    // same clipping as Adafruit_SPITFT, negative sizes grow the other way
+    if( !w || !h )
+        return false;
+
+    if( w < 0 )
+    {
+        x += w + 1;
+        w  = -w;
+    }
+    if( h < 0 )
+    {
+        y += h + 1;
+        h  = -h;
+    }
+    if( x >= width || y >= height || x + w - 1 < 0 || y + h - 1 < 0 )
+        return false;
+
+    if( x < 0 )
+    {
+        w += x;
+        x  = 0;
+    }
+    if( y < 0 )
+    {
+        h += y;
+        y  = 0;
+    }
+    if( x + w > width )
+        w = width - x;
+    if( y + h > height )
+        h = height - y;
+
+    return true;
+}
+
+
+void Adafruit_ST7735::writeFillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+    if( s_stubbed )
+        return;
+
+    if( !clip( x, y, w, h, m_width, m_height ) )
+        return;
+
+    setAddrWindow( x, y, w, h );
+    s_panel.data16( color, (uint32_t)w * h );
+}
+
+
+void Adafruit_ST7735::writeFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color )
+{
+    writeFillRect( x, y, 1, h, color );
+}
+
+
+void Adafruit_ST7735::writeFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color )
+{
+    writeFillRect( x, y, w, 1, color );
+}
+
+
+void Adafruit_ST7735::drawPixel( int16_t x, int16_t y, uint16_t color )
+{
+    if( s_stubbed )
+        return;
+
+    if( x < 0 || y < 0 || x >= m_width || y >= m_height )
+        return;
+
+    startWrite();
+    writePixel( x, y, color );
+    endWrite();
+}
+
+
+void Adafruit_ST7735::fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+    if( s_stubbed )
+        return;
+
+    // nothing goes over the wire, not even a transaction, if it is all clipped
+    if( !clip( x, y, w, h, m_width, m_height ) )
+        return;
+
+    startWrite();
+    setAddrWindow( x, y, w, h );
+    s_panel.data16( color, (uint32_t)w * h );
+    endWrite();
+}
+
+
+void Adafruit_ST7735::drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color )
+{
+    fillRect( x, y, 1, h, color );
+}
+
+
+void Adafruit_ST7735::drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color )
+{
+    fillRect( x, y, w, 1, color );
+}
+
+
+uint16_t Adafruit_ST7735::readPixel( int16_t x, int16_t y ) const
+{
+    if( x < 0 || y < 0 || x >= m_width || y >= m_height )
+        return 0;
+
+    return s_panel.pixel( x + m_xstart, y + m_ystart );
+}
+
+
+// EOF
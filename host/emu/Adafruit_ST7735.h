@@ -0,0 +1,78 @@
+//
+//  Adafruit_ST7735.h
+//  
+//
+//  Host only: Adafruit_ST7735 driving St7735Emu instead of the SPI bus. Commands, address
+//  windows and pixel pushes are issued the way Adafruit_SPITFT/Adafruit_ST77xx issue them.
+//
+
+#ifndef Adafruit_ST7735_h
+#define Adafruit_ST7735_h
+
+#include "Adafruit_GFX.h"
+#include "st7735_emu.h"
+
+
+#define INITR_GREENTAB    0x00
+#define INITR_REDTAB      0x01
+#define INITR_BLACKTAB    0x02
+#define INITR_MINI160x80  0x04
+
+#define ST7735_TFTWIDTH_80    80
+#define ST7735_TFTHEIGHT_160  160
+
+#define ST77XX_BLACK      0x0000
+#define ST77XX_WHITE      0xFFFF
+#define ST77XX_RED        0xF800
+#define ST77XX_GREEN      0x07E0
+#define ST77XX_BLUE       0x001F
+#define ST77XX_CYAN       0x07FF
+#define ST77XX_MAGENTA    0xF81F
+#define ST77XX_YELLOW     0xFFE0
+#define ST77XX_ORANGE     0xFC00
+
+
+class Adafruit_ST7735 : public Adafruit_GFX
+{
+public:
+    Adafruit_ST7735( int8_t cs, int8_t dc, int8_t rst );
+
+    void initR( uint8_t options = INITR_GREENTAB );
+    void setRotation( uint8_t r );
+    void invertDisplay( bool i );
+    void setAddrWindow( uint16_t x, uint16_t y, uint16_t w, uint16_t h );
+    void sendCommand( uint8_t command, const uint8_t* data = NULL, uint8_t count = 0 );
+
+    void startWrite();
+    void endWrite();
+    void writePixel( int16_t x, int16_t y, uint16_t color );
+    void writeFillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    void writeFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color );
+    void writeFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color );
+    void drawPixel( int16_t x, int16_t y, uint16_t color );
+    void fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    void drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color );
+    void drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color );
+
+    // what is on the glass at a screen position, for checking the framebuffer in tests
+    uint16_t readPixel( int16_t x, int16_t y ) const;
+
+private:
+    void     displayInit( const uint8_t* list );
+    void     writeCommand( uint8_t command );
+
+    uint8_t  m_tab;
+    uint8_t  m_colstart;
+    uint8_t  m_rowstart;
+    int16_t  m_xstart;
+    int16_t  m_ystart;
+};
+
+
+St7735Emu* emulator_panel();
+
+// with drawing stubbed out nothing reaches the panel, for timing the game logic on its own
+void       emulator_stub_drawing( bool stub );
+
+
+#endif /* Adafruit_ST7735_h */
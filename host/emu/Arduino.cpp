@@ -0,0 +1,144 @@
+//
+//  Arduino.cpp
+//  
+//
+
+#include "Arduino.h"
+#include "Adafruit_ST7735.h"
+
+
+HardwareSerial Serial;
+
+static uint64_t s_clock_us = 0;    // everything but the display, which keeps its own time
+static jmp_buf  s_halt;
+static uint32_t s_random   = 1;
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t Print::print( const char* s )
+{
+    size_t n = 0;
+    while( *s )
+        n += write( *s++ );
+    return n;
+}
+
+
+size_t Print::print( long n, int base )
+{
+    if( n < 0 && base == DEC )
+        return print( '-' ) + print( (unsigned long)-n, base );
+
+    return print( (unsigned long)n, base );
+}
+
+
+size_t Print::print( unsigned long n, int base )
+{
+    char  buffer[8 * sizeof( long ) + 1];
+    char* s = &buffer[sizeof( buffer ) - 1];
+    *s = 0;
+    do
+    {
+        unsigned long digit = n % base;
+        *--s = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        n /= base;
+    } while( n );
+
+    return print( s );
+}
+
+
+size_t HardwareSerial::write( uint8_t c )
+{
+    if( !m_quiet && c != '\r' )
+        fputc( c, stderr );
+    return 1;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t emulator_micros()
+{
+    St7735Emu* panel = emulator_panel();
+    return s_clock_us + (uint64_t)panel->time_us( panel->stats() );
+}
+
+
+void emulator_advance( uint64_t us )
+{
+    s_clock_us += us;
+}
+
+
+jmp_buf& emulator_halt_point()
+{
+    return s_halt;
+}
+
+
+void emulator_halt()
+{
+    longjmp( s_halt, 1 );
+}
+
+
+void delay( unsigned long ms )
+{
+    s_clock_us += ms * 1000ULL;
+}
+
+
+unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+
+unsigned long micros()
+{
+    // reading the clock isn't free, this keeps busy waits moving
+    s_clock_us += 1;
+    return (unsigned long)emulator_micros();
+}
+
+
+long random( long max_value )
+{
+    if( max_value <= 0 )
+        return 0;
+
+    // xorshift32, the stream snake_batch.cpp gives each game, so a game can be replayed there
+    s_random ^= s_random << 13;
+    s_random ^= s_random >> 17;
+    s_random ^= s_random << 5;
+    return s_random % max_value;
+}
+
+
+long random( long min_value, long max_value )
+{
+    return min_value >= max_value ? min_value : min_value + random( max_value - min_value );
+}
+
+
+void randomSeed( unsigned long seed )
+{
+    // xorshift must never be seeded with zero
+    s_random = (uint32_t)seed | 1;
+}
+
+
+int analogRead( uint8_t )
+{
+    return rand() & 0x3FF;
+}
+
+
+// EOF
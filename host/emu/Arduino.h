@@ -0,0 +1,87 @@
+//
+//  Arduino.h
+//  
+//
+//  Host only: just enough of the Arduino core to build snake.cpp against the panel emulator.
+//  Time is virtual, it moves with delay(), with the estimated SPI time of everything drawn,
+//  and by a microsecond every time the clock is read so polling loops terminate.
+//
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <algorithm>
+
+// we stand in for a Feather M4 Express
+#ifndef __SAMD51__
+#define __SAMD51__
+#endif
+
+#define DEC 10
+#define HEX 16
+
+using std::min;
+using std::max;
+#define constrain( amt, low, high ) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write( uint8_t c ) = 0;
+
+    size_t print( const char* s );
+    size_t print( char c )                      { return write( c ); }
+    size_t print( int n, int base = DEC )       { return print( (long)n, base ); }
+    size_t print( unsigned n, int base = DEC )  { return print( (unsigned long)n, base ); }
+    size_t print( long n, int base = DEC );
+    size_t print( unsigned long n, int base = DEC );
+    size_t print( long long n, int base = DEC ) { return print( (long)n, base ); }
+    size_t print( unsigned long long n, int base = DEC ) { return print( (unsigned long)n, base ); }
+
+    template <typename T>
+    size_t println( T value )                   { size_t n = print( value ); return n + println(); }
+    template <typename T>
+    size_t println( T value, int base )         { size_t n = print( value, base ); return n + println(); }
+    size_t println()                            { return print( "\r\n" ); }
+};
+
+
+class HardwareSerial : public Print
+{
+public:
+    HardwareSerial() : m_quiet( false ) {}
+
+    void   begin( unsigned long ) {}
+    void   set_quiet( bool quiet ) { m_quiet = quiet; }
+    size_t write( uint8_t c );
+
+private:
+    bool   m_quiet;
+};
+
+
+extern HardwareSerial Serial;
+
+void          delay( unsigned long ms );
+unsigned long millis();
+unsigned long micros();
+long          random( long max_value );
+long          random( long min_value, long max_value );
+void          randomSeed( unsigned long seed );
+int           analogRead( uint8_t pin );
+
+// the emulator clock, and a way out of game_over() which never returns on the device
+uint64_t      emulator_micros();
+void          emulator_advance( uint64_t us );
+jmp_buf&      emulator_halt_point();
+void          emulator_halt();
+
+
+#endif /* Arduino_h */
@@ -0,0 +1,133 @@
+//
+//  level_encode.cpp
+//
+//
+//  Host only: turns a text map into a level in the format described at the top of snake.cpp.
+//  Every line of the map is a row of tiles, '#' is a wall and anything else is open floor.
+//    level_encode [-t tile_pixels] map.txt level1
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+
+static void put_short( std::vector<uint8_t>& out, uint16_t value )
+{
+    out.push_back( value & 0xFF );
+    out.push_back( value >> 8 );
+}
+
+
+static bool read_map( const char* path, std::vector<std::string>& rows )
+{
+    FILE* file = fopen( path, "r" );
+    if( !file )
+        return false;
+
+    std::string row;
+    int c;
+    while( (c = fgetc( file )) != EOF )
+    {
+        if( c == '\n' )
+        {
+            rows.push_back( row );
+            row.clear();
+        }
+        else if( c != '\r' )
+            row += (char)c;
+    }
+    if( !row.empty() )
+        rows.push_back( row );
+
+    fclose( file );
+    return true;
+}
+
+
+static void encode( const std::vector<std::string>& rows, uint8_t tile, std::vector<uint8_t>& out )
+{
+    size_t width = 0;
+    for( size_t i = 0; i < rows.size(); i++ )
+        width = rows[i].size() > width ? rows[i].size() : width;
+
+    out.push_back( 'S' );
+    out.push_back( 'L' );
+    out.push_back( 1 );
+    out.push_back( tile );
+    put_short( out, (uint16_t)width );
+    put_short( out, (uint16_t)rows.size() );
+
+    // the row table gets filled in as the runs are written
+    size_t table = out.size();
+    out.resize( table + rows.size() * sizeof( uint16_t ) );
+
+    for( size_t row = 0; row < rows.size(); row++ )
+    {
+        out[table + row * 2]     = out.size() & 0xFF;
+        out[table + row * 2 + 1] = out.size() >> 8;
+
+        // short rows are padded with floor
+        size_t col = 0;
+        while( col < width )
+        {
+            bool   wall  = col < rows[row].size() && rows[row][col] == '#';
+            size_t count = 1;
+            while( count < 128 && col + count < width && (col + count < rows[row].size() && rows[row][col + count] == '#') == wall )
+                ++count;
+
+            out.push_back( (wall ? 0x80 : 0) | (uint8_t)(count - 1) );
+            col += count;
+        }
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+    int tile = 4;
+    int arg  = 1;
+    if( arg + 1 < argc && !strcmp( argv[arg], "-t" ) )
+    {
+        tile = atoi( argv[arg + 1] );
+        arg += 2;
+    }
+
+    if( argc - arg != 2 || tile < 1 || tile > 255 )
+    {
+        fprintf( stderr, "usage: level_encode [-t tile_pixels] map.txt level\n" );
+        return 1;
+    }
+
+    std::vector<std::string> rows;
+    if( !read_map( argv[arg], rows ) || rows.empty() )
+    {
+        fprintf( stderr, "can't read %s\n", argv[arg] );
+        return 1;
+    }
+
+    std::vector<uint8_t> level;
+    encode( rows, (uint8_t)tile, level );
+    if( level.size() > 0xFFFF )
+    {
+        // row offsets are 16 bit
+        fprintf( stderr, "%s is too big to encode\n", argv[arg] );
+        return 1;
+    }
+
+    FILE* file = fopen( argv[arg + 1], "wb" );
+    if( !file || fwrite( level.data(), 1, level.size(), file ) != level.size() )
+    {
+        fprintf( stderr, "can't write %s\n", argv[arg + 1] );
+        return 1;
+    }
+    fclose( file );
+
+    printf( "%s: %d x %d tiles of %d pixels, %zu bytes\n", argv[arg + 1], level[4] | level[5] << 8, level[6] | level[7] << 8, tile, level.size() );
+    return 0;
+}
+
+// EOF
@@ -0,0 +1,151 @@
+//
+//  render_bench.cpp
+//  
+//
+//  Host only: runs snake.cpp against the ST7735 emulator and scores each part of the game
+//  in bytes on the wire and estimated time. Build it with -DCELL_GRID to score the cell mode.
+//    render_bench [-v] [-c spi_clock_hz] [-f frames] [-l level_file]
+//
+
+#include "snake.h"
+#include "st7735_emu.h"
+#include "Adafruit_SPIFlash_FatFs.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+void place_apple();
+void game_over();
+
+static St7735Emu* s_panel;
+static PanelStats s_frame_start;     // so a game over during play doesn't count as a frame
+
+
+static void report( const char* name, uint32_t frames = 1, const PanelStats* until = NULL )
+{
+    PanelStats end   = until ? *until : s_panel->stats();
+    PanelStats stats = panel_stats_since( end, s_panel->marked() );
+    double     wire  = stats.commands + (double)stats.data_bytes;
+    printf( "%-14s %8u %12.1f %12.1f %12.1f %12.1f\n", name, frames,
+            stats.transactions / (double)frames, stats.commands / (double)frames,
+            wire / frames, s_panel->time_us( stats ) / frames );
+    s_panel->mark( end );
+}
+
+
+static uint32_t count_pixels( uint16_t color )
+{
+    Adafruit_ST7735* tft   = get_tft();
+    uint32_t         count = 0;
+    for( int16_t y = 0; y < tft->height(); y++ )
+    {
+        for( int16_t x = 0; x < tft->width(); x++ )
+            count += tft->readPixel( x, y ) == color;
+    }
+
+    return count;
+}
+
+
+static bool play( uint32_t frames, volatile uint32_t* played, volatile int64_t* ticking_ns )
+{
+    // go round in a rectangle, a turn every 20 frames. The counts are read after game_over()
+    // jumps back here, so they can't live in registers
+    if( setjmp( emulator_halt_point() ) )
+        return true;
+
+    for( ; *played < frames; ++*played )
+    {
+        s_frame_start = s_panel->stats();
+        draw_snake();
+        switch( *played % 80 )
+        {
+            case 20: move_left();  break;
+            case 40: move_down();  break;
+            case 60: move_right(); break;
+            case 0:  if( *played ) move_up(); break;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        move_snake();
+        *ticking_ns += std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    return false;
+}
+
+
+int main( int argc, char** argv )
+{
+    uint32_t frames  = 400;
+    bool     verbose = false;
+    s_panel = emulator_panel();
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( !strcmp( argv[i], "-v" ) )
+            verbose = true;
+        else if( !strcmp( argv[i], "-c" ) && i + 1 < argc )
+            s_panel->set_clock( atoi( argv[++i] ) );
+        else if( !strcmp( argv[i], "-f" ) && i + 1 < argc )
+            frames = atoi( argv[++i] );
+        else if( !strcmp( argv[i], "-l" ) && i + 1 < argc && !emulator_load_file( "level1", argv[++i] ) )
+        {
+            fprintf( stderr, "can't read %s\n", argv[i] );
+            return 1;
+        }
+    }
+
+    Serial.set_quiet( !verbose );
+    randomSeed( 1 );
+
+    printf( "%-14s %8s %12s %12s %12s %12s\n", "", "frames", "trans/frame", "cmds/frame", "bytes/frame", "us/frame" );
+    s_panel->mark();
+
+    initialize_graphics();
+    report( "init" );
+
+    draw_intro( NULL );
+    report( "draw_intro" );
+
+    start_game();
+    report( "start_game" );
+
+    place_apple();
+    report( "place_apple" );
+
+    volatile uint32_t played     = 0;
+    volatile int64_t  ticking_ns = 0;
+    bool              ended      = play( frames, &played, &ticking_ns );
+    if( ended )
+    {
+        // the last frame ran into something, from its start on it's all game over
+        report( "frame", played ? played : 1, &s_frame_start );
+        report( "game_over" );
+    }
+    else
+        report( "frame", played ? played : 1 );
+    printf( "%-14s %8u green pixels on the glass\n", "", count_pixels( ST77XX_GREEN ) );
+    printf( "%-14s %8.0f ns host time per move_snake(), tail drawing included\n", "",
+            (double)ticking_ns / (played ? played : 1) );
+    printf( "%-14s %8u bytes of board state, %ux%u pixel cells\n", "", get_board_memory(), get_cell_size(), get_cell_size() );
+
+    restore_board();
+    report( "restore_board" );
+
+    if( !ended )
+    {
+        if( !setjmp( emulator_halt_point() ) )
+            game_over();
+        report( "game_over" );
+    }
+
+    printf( "virtual time: %.1f ms\n", emulator_micros() / 1000.0 );
+    return 0;
+}
+
+
+// EOF
@@ -0,0 +1,215 @@
+//
+//  render_test.cpp
+//
+//
+//  Host only: runs snake.cpp against the ST7735 emulator and fails if a part of the game goes
+//  over its budget on the wire, or if the different ways of drawing the board disagree.
+//  Build it with -DCELL_GRID to check the cell mode.
+//    render_test level_file
+//
+
+#include "snake.h"
+#include "st7735_emu.h"
+#include "Adafruit_SPIFlash_FatFs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+// what it takes today plus some room, bytes are command and data bytes on the wire
+#define kInitBudget      { 26,   28000 }
+#define kIntroBudget     { 64,   40000 }
+#define kStartBudget     { 48,   34000 }
+#define kAppleBudget     { 1,    64 }
+#define kSnakeBudget     { 1,    96 }         // a single draw_snake(), when the view doesn't move
+#define kRestoreBudget   { 48,   34000 }
+#define kGameOverBudget  { 72,   36000 }
+
+#define kFrames          1500
+
+
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t bytes;
+} Budget;
+
+
+void place_apple();
+void erase_apple();
+void game_over();
+void draw_dot( int16_t x_pos, int16_t y_pos, uint16_t color );
+void draw_span( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color );
+
+static St7735Emu* s_panel;
+static int        s_failures = 0;
+
+
+#define CHECK( condition, ... ) \
+    do { if( !(condition) ) { printf( "FAIL %s:%d: ", __FILE__, __LINE__ ); printf( __VA_ARGS__ ); printf( "\n" ); ++s_failures; } } while( 0 )
+
+
+static void check_budget( const char* name, Budget budget, bool print = true )
+{
+    // over budget is a failure, the numbers get printed so they can be tightened
+    PanelStats stats = s_panel->since_mark();
+    uint64_t   bytes = stats.commands + stats.data_bytes;
+    if( print )
+        printf( "%-14s %4u transactions %8llu bytes\n", name, stats.transactions, (unsigned long long)bytes );
+    CHECK( stats.transactions <= budget.transactions, "%s took %u transactions, budget is %u", name, stats.transactions, budget.transactions );
+    CHECK( bytes <= budget.bytes, "%s sent %llu bytes, budget is %u", name, (unsigned long long)bytes, budget.bytes );
+    s_panel->mark();
+}
+
+
+static std::vector<uint16_t> grab_screen()
+{
+    Adafruit_ST7735*      tft = get_tft();
+    std::vector<uint16_t> screen;
+    for( int16_t y = 0; y < tft->height(); y++ )
+    {
+        for( int16_t x = 0; x < tft->width(); x++ )
+            screen.push_back( tft->readPixel( x, y ) );
+    }
+
+    return screen;
+}
+
+
+static uint32_t count_differences( const std::vector<uint16_t>& a, const std::vector<uint16_t>& b )
+{
+    uint32_t count = 0;
+    for( size_t i = 0; i < a.size(); i++ )
+        count += a[i] != b[i];
+
+    return count;
+}
+
+
+static void check_span( int16_t x0, int16_t y0, int16_t x1, int16_t y1 )
+{
+    // a span has to cover exactly what a dot at every point along it would
+    Adafruit_ST7735* tft = get_tft();
+    tft->fillScreen( ST77XX_BLACK );
+    draw_span( x0, y0, x1, y1, ST77XX_GREEN );
+    std::vector<uint16_t> span = grab_screen();
+
+    tft->fillScreen( ST77XX_BLACK );
+    int16_t dir_x = (x1 > x0) - (x1 < x0);
+    int16_t dir_y = (y1 > y0) - (y1 < y0);
+    for( int16_t x = x0, y = y0; ; x += dir_x, y += dir_y )
+    {
+        draw_dot( x, y, ST77XX_GREEN );
+        if( x == x1 && y == y1 )
+            break;
+    }
+
+    uint32_t differences = count_differences( span, grab_screen() );
+    CHECK( !differences, "span (%d, %d) -> (%d, %d) differs from its dots in %u pixels", x0, y0, x1, y1, differences );
+}
+
+
+static void check_spans()
+{
+    int16_t right  = get_tft()->width() / get_cell_size() - 1;
+    int16_t bottom = get_tft()->height() / get_cell_size() - 1;
+
+    check_span( 10, 10, 10, 10 );
+    check_span( 5, 7, 25, 7 );
+    check_span( 25, 7, 5, 7 );
+    check_span( 12, 3, 12, 17 );
+    check_span( 12, 17, 12, 3 );
+
+    // partly off the screen
+    check_span( 0, 0, right, 0 );
+    check_span( right, 0, right, bottom );
+    check_span( -2, bottom, 6, bottom );
+}
+
+
+static void check_restore( uint32_t frame )
+{
+    // the board drawn from scratch has to look just like the one drawn a tick at a time
+    std::vector<uint16_t> incremental = grab_screen();
+    s_panel->mark();
+    restore_board();
+    check_budget( "restore_board", (Budget)kRestoreBudget, !frame );
+
+    uint32_t differences = count_differences( incremental, grab_screen() );
+    CHECK( !differences, "restore_board() differs from the incrementally drawn board in %u pixels after %u frames", differences, frame );
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc != 2 || !emulator_load_file( "level1", argv[1] ) )
+    {
+        fprintf( stderr, "usage: render_test level_file\n" );
+        return 1;
+    }
+
+    s_panel = emulator_panel();
+    Serial.set_quiet( true );
+    randomSeed( 1 );
+    s_panel->mark();
+
+    initialize_graphics();
+    check_budget( "init", (Budget)kInitBudget );
+
+    check_spans();
+    get_tft()->fillScreen( ST77XX_BLACK );
+    s_panel->mark();
+
+    draw_intro( NULL );
+    check_budget( "draw_intro", (Budget)kIntroBudget );
+
+    start_game();
+    check_budget( "start_game", (Budget)kStartBudget );
+
+    erase_apple();
+    s_panel->mark();
+    place_apple();
+    check_budget( "place_apple", (Budget)kAppleBudget );
+
+    // go round a rectangle that stays clear of the walls of the arena, restoring the board every frame
+    uint32_t frame = 0;
+    uint32_t worst = 0;
+    if( !setjmp( emulator_halt_point() ) )
+    {
+        for( ; frame < kFrames; frame++ )
+        {
+            PanelStats before = s_panel->stats();
+            draw_snake();
+            PanelStats stats = panel_stats_since( s_panel->stats(), before );
+            Budget     budget = kSnakeBudget;
+            uint32_t   bytes  = stats.commands + stats.data_bytes;
+            worst = max( worst, bytes );
+            CHECK( stats.transactions <= budget.transactions && bytes <= budget.bytes,
+                   "draw_snake() took %u transactions and %u bytes on frame %u", stats.transactions, bytes, frame );
+
+            check_restore( frame );
+
+            switch( frame % 120 )
+            {
+                case 30: move_right(); break;
+                case 60: move_down();  break;
+                case 90: move_left();  break;
+                case 0:  if( frame ) move_up(); break;
+            }
+            move_snake();
+        }
+    }
+    printf( "%-14s %4u frames, worst %u bytes\n", "draw_snake", frame, worst );
+
+    s_panel->mark();
+    if( !setjmp( emulator_halt_point() ) )
+        game_over();
+    check_budget( "game_over", (Budget)kGameOverBudget );
+
+    printf( s_failures ? "%d failures\n" : "ok\n", s_failures );
+    return s_failures ? 1 : 0;
+}
+
+
+// EOF
@@ -0,0 +1,631 @@
+//
+//  snake_batch.cpp
+//
+//
+//  Host only, build with something like:
+//    c++ -O3 -march=native -I. -o batch_bench host/snake_batch.cpp host/batch_bench.cpp
+//
+//  Games are kept as a struct of arrays so the common work (speed, moving heads, apple and
+//  boundary tests) runs as straight loops over every game that the compiler can vectorize.
+//  Turns, apples eaten, the tail and segment bookkeeping are handled one game at a time with
+//  the same steps as snake.cpp.
+//
+
+#include "snake_batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define kLevelHeaderSize  8
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static T* alloc_array( uint32_t count )
+{
+    return (T*)calloc( count, sizeof( T ) );
+}
+
+
+static inline int16_t min16( int16_t a, int16_t b )
+{
+    return a < b ? a : b;
+}
+
+
+static inline int16_t max16( int16_t a, int16_t b )
+{
+    return a > b ? a : b;
+}
+
+
+static uint32_t next_random( SnakeBatch* b, uint32_t game )
+{
+    // xorshift32, one stream per game
+    uint32_t x = b->rng[game];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    b->rng[game] = x;
+    return x;
+}
+
+
+static int16_t random_between( SnakeBatch* b, uint32_t game, int16_t low, int16_t high )
+{
+    // random( low, high ) as the emulator does it
+    return low >= high ? low : low + next_random( b, game ) % (high - low);
+}
+
+
+#ifndef CELL_GRID
+static bool dot_in_segment( SnakeBatch* b, uint32_t seg, int16_t x, int16_t y, int16_t tolerance )
+{
+    // same test as dot_in_segment() in snake.cpp
+    if( b->seg_x[seg] == b->seg_start_x[seg] )
+    {
+        if( abs( x - b->seg_x[seg] ) <= tolerance )
+            return y > min16( b->seg_start_y[seg], b->seg_y[seg] ) && y < max16( b->seg_start_y[seg], b->seg_y[seg] );
+    }
+    else
+    {
+        if( abs( y - b->seg_y[seg] ) <= tolerance )
+            return x > min16( b->seg_start_x[seg], b->seg_x[seg] ) && x < max16( b->seg_start_x[seg], b->seg_x[seg] );
+    }
+
+    return false;
+}
+#endif
+
+
+static bool span_in_segment( SnakeBatch* b, uint32_t seg, int16_t min_x, int16_t min_y, int16_t max_x, int16_t max_y )
+{
+    // same test as span_in_segment() in snake.cpp
+    int16_t x = b->seg_x[seg], start_x = b->seg_start_x[seg];
+    int16_t y = b->seg_y[seg], start_y = b->seg_start_y[seg];
+    if( x == start_x )
+    {
+        if( x >= min_x && x <= max_x )
+        {
+            int16_t lo = start_y < y ? start_y + 1 : y + 1 - kTurnCell;
+            int16_t hi = start_y < y ? y - 1 + kTurnCell : start_y - 1;
+            return lo <= hi && min_y <= hi && max_y >= lo;
+        }
+    }
+    else
+    {
+        if( y >= min_y && y <= max_y )
+        {
+            int16_t lo = start_x < x ? start_x + 1 : x + 1 - kTurnCell;
+            int16_t hi = start_x < x ? x - 1 + kTurnCell : start_x - 1;
+            return lo <= hi && min_x <= hi && max_x >= lo;
+        }
+    }
+
+    return false;
+}
+
+
+static inline uint32_t segment_index( SnakeBatch* b, uint32_t game, uint16_t i )
+{
+    // i-th segment from the tail, the first one is at the reader index
+    return game * kMaxSegments + (b->seg_reader[game] + i) % kMaxSegments;
+}
+
+
+static bool blocked( SnakeBatch* b, int16_t x, int16_t y )
+{
+    if( !b->blocked || x < 0 || y < 0 || x >= b->board_width || y >= b->board_height )
+        return false;
+
+    return b->blocked[y * b->board_width + x];
+}
+
+
+static bool apple_in_snake( SnakeBatch* b, uint32_t game )
+{
+    // apple_in_segment()
+    for( uint16_t i = 0; i < b->seg_count[game]; i++ )
+    {
+        uint32_t seg = segment_index( b, game, i );
+#ifdef CELL_GRID
+        if( span_in_segment( b, seg, b->apple_x[game], b->apple_y[game], b->apple_x[game], b->apple_y[game] ) )
+#else
+        if( dot_in_segment( b, seg, b->apple_x[game], b->apple_y[game], kLineTolerance ) )
+#endif
+            return true;
+    }
+
+    return false;
+}
+
+
+static void place_apple( SnakeBatch* b, uint32_t game )
+{
+    // never on top of the snake or a wall, and somewhere in view
+    int16_t left   = b->view_col[game] * b->tile / kCellSize;
+    int16_t top    = b->view_row[game] * b->tile / kCellSize;
+    int16_t right  = min16( left + kPanelWidth / kCellSize, b->board_width );
+    int16_t bottom = min16( top + kPanelHeight / kCellSize, b->board_height );
+    do
+    {
+        b->apple_x[game] = random_between( b, game, left, right );
+        b->apple_y[game] = random_between( b, game, top, bottom );
+    } while( apple_in_snake( b, game ) || blocked( b, b->apple_x[game], b->apple_y[game] ) );
+}
+
+
+static void add_segment( SnakeBatch* b, uint32_t game )
+{
+    // a turn made before the head has moved on replaces the one made there
+    if( b->seg_count[game] )
+    {
+        uint32_t newest = game * kMaxSegments + (b->seg_writer[game] + kMaxSegments - 1) % kMaxSegments;
+        if( b->seg_x[newest] == b->head_x[game] && b->seg_y[newest] == b->head_y[game] )
+        {
+            b->seg_dir_x[newest] = b->head_dir_x[game];
+            b->seg_dir_y[newest] = b->head_dir_y[game];
+            return;
+        }
+    }
+
+    uint32_t seg = game * kMaxSegments + b->seg_writer[game];
+    b->seg_x[seg]     = b->head_x[game];
+    b->seg_y[seg]     = b->head_y[game];
+    b->seg_dir_x[seg] = b->head_dir_x[game];
+    b->seg_dir_y[seg] = b->head_dir_y[game];
+
+    // if this is the first segment, the end of it is not the starting point, it's the tail
+    if( !b->seg_count[game] )
+    {
+        b->next_start_x[game] = b->tail_x[game];
+        b->next_start_y[game] = b->tail_y[game];
+    }
+
+    b->seg_start_x[seg] = b->next_start_x[game];
+    b->seg_start_y[seg] = b->next_start_y[game];
+    ++b->seg_count[game];
+    if( ++b->seg_writer[game] >= kMaxSegments )
+        b->seg_writer[game] = 0;
+
+    b->next_start_x[game] = b->head_x[game];
+    b->next_start_y[game] = b->head_y[game];
+}
+
+
+static bool turning_back( SnakeBatch* b, uint32_t game, int16_t dir_x, int16_t dir_y )
+{
+    // turning_back(), newest segment first
+    for( uint16_t i = 0; i < b->seg_count[game]; i++ )
+    {
+        uint32_t seg = segment_index( b, game, b->seg_count[game] - 1 - i );
+        if( b->seg_x[seg] != b->head_x[game] || b->seg_y[seg] != b->head_y[game] )
+            return false;
+
+        if( b->seg_x[seg] != b->seg_start_x[seg] || b->seg_y[seg] != b->seg_start_y[seg] )
+            return dir_x == (b->seg_x[seg] < b->seg_start_x[seg]) - (b->seg_x[seg] > b->seg_start_x[seg]) &&
+                   dir_y == (b->seg_y[seg] < b->seg_start_y[seg]) - (b->seg_y[seg] > b->seg_start_y[seg]);
+    }
+
+    return false;
+}
+
+
+static void turn( SnakeBatch* b, uint32_t game, uint8_t action )
+{
+    int16_t dir_x = action == kActionLeft ? -1 : action == kActionRight ? 1 : 0;
+    int16_t dir_y = action == kActionUp   ? -1 : action == kActionDown  ? 1 : 0;
+
+    // already going that way, trying to turn back on ourselves or out of room for the turn
+    if( dir_x == b->head_dir_x[game] && dir_y == b->head_dir_y[game] )
+        return;
+    if( dir_x == -b->head_dir_x[game] && dir_y == -b->head_dir_y[game] )
+        return;
+    if( turning_back( b, game, dir_x, dir_y ) )
+        return;
+    if( b->seg_count[game] >= kMaxSegments )
+        return;
+
+    b->head_dir_x[game] = dir_x;
+    b->head_dir_y[game] = dir_y;
+    add_segment( b, game );
+}
+
+
+static void eat( SnakeBatch* b, uint32_t game )
+{
+    // check_for_apple() once it's a hit
+    if( b->delay[game] > kMinDelay )
+        --b->delay[game];
+    else if( b->speed[game] < kMaxSpeed )
+        b->speed[game] += kSpeedStep;
+    b->length[game] += kAppleGrowth;
+    place_apple( b, game );
+    ++b->score[game];
+}
+
+
+static void check_for_direction_change( SnakeBatch* b, uint32_t game )
+{
+    // several turns can land on the same spot if more than one direction was pressed at once
+    uint32_t seg = game * kMaxSegments + b->seg_reader[game];
+    while( b->seg_count[game] && b->seg_x[seg] == b->tail_x[game] && b->seg_y[seg] == b->tail_y[game] )
+    {
+        b->tail_dir_x[game] = b->seg_dir_x[seg];
+        b->tail_dir_y[game] = b->seg_dir_y[seg];
+        --b->seg_count[game];
+        if( ++b->seg_reader[game] >= kMaxSegments )
+            b->seg_reader[game] = 0;
+        seg = game * kMaxSegments + b->seg_reader[game];
+    }
+
+    if( b->seg_count[game] )
+    {
+        b->seg_start_x[seg] = b->tail_x[game];
+        b->seg_start_y[seg] = b->tail_y[game];
+    }
+}
+
+
+static void move_tail( SnakeBatch* b, uint32_t game, uint16_t steps )
+{
+    // move_eraser(), taking a turn made where the tail stands first and never stepping over the next one
+    if( steps )
+        check_for_direction_change( b, game );
+
+    while( steps )
+    {
+        uint16_t run = steps;
+        if( b->seg_count[game] )
+        {
+            uint32_t seg      = game * kMaxSegments + b->seg_reader[game];
+            uint16_t distance = abs( b->seg_x[seg] - b->tail_x[game] ) + abs( b->seg_y[seg] - b->tail_y[game] );
+            if( distance && distance < run )
+                run = distance;
+        }
+
+        b->tail_x[game] += b->tail_dir_x[game] * run;
+        b->tail_y[game] += b->tail_dir_y[game] * run;
+        check_for_direction_change( b, game );
+        steps -= run;
+    }
+}
+
+
+static bool head_in_snake( SnakeBatch* b, uint32_t game )
+{
+    // snake_in_segment(), the path the head took this step not including where it started
+    int16_t min_x = min16( b->from_x[game] + b->head_dir_x[game], b->head_x[game] );
+    int16_t max_x = max16( b->from_x[game] + b->head_dir_x[game], b->head_x[game] );
+    int16_t min_y = min16( b->from_y[game] + b->head_dir_y[game], b->head_y[game] );
+    int16_t max_y = max16( b->from_y[game] + b->head_dir_y[game], b->head_y[game] );
+    for( uint16_t i = 0; i < b->seg_count[game]; i++ )
+    {
+        if( span_in_segment( b, segment_index( b, game, i ), min_x, min_y, max_x, max_y ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+static bool head_in_wall( SnakeBatch* b, uint32_t game )
+{
+    // level_in_path()
+    int16_t x = b->from_x[game];
+    int16_t y = b->from_y[game];
+    while( x != b->head_x[game] || y != b->head_y[game] )
+    {
+        x += b->head_dir_x[game];
+        y += b->head_dir_y[game];
+        if( blocked( b, x, y ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+static uint16_t scroll_axis( SnakeBatch* b, int16_t head, uint16_t view, uint16_t tiles, int16_t screen )
+{
+    // same as scroll_axis() in snake.cpp
+    int16_t on_screen = head - view * b->tile;
+    if( on_screen >= kScrollMargin && on_screen < screen - kScrollMargin )
+        return view;
+
+    uint16_t visible = screen / b->tile;
+    if( tiles <= visible )
+        return 0;
+
+    int16_t centre = (head - screen / 2) / b->tile;
+    return centre < 0 ? 0 : centre > tiles - visible ? tiles - visible : centre;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SnakeBatch* batch_create( uint32_t count, uint32_t seed )
+{
+    SnakeBatch* b = alloc_array<SnakeBatch>( 1 );
+    b->count        = count;
+    b->board_width  = kPanelWidth / kCellSize;
+    b->board_height = kPanelHeight / kCellSize;
+
+    b->head_x     = alloc_array<int16_t>( count );
+    b->head_y     = alloc_array<int16_t>( count );
+    b->head_dir_x = alloc_array<int16_t>( count );
+    b->head_dir_y = alloc_array<int16_t>( count );
+    b->tail_x     = alloc_array<int16_t>( count );
+    b->tail_y     = alloc_array<int16_t>( count );
+    b->tail_dir_x = alloc_array<int16_t>( count );
+    b->tail_dir_y = alloc_array<int16_t>( count );
+    b->length     = alloc_array<uint16_t>( count );
+    b->counter    = alloc_array<uint16_t>( count );
+    b->speed      = alloc_array<uint16_t>( count );
+    b->speed_frac = alloc_array<uint16_t>( count );
+    b->delay      = alloc_array<uint16_t>( count );
+    b->view_col   = alloc_array<uint16_t>( count );
+    b->view_row   = alloc_array<uint16_t>( count );
+
+    b->apple_x    = alloc_array<int16_t>( count );
+    b->apple_y    = alloc_array<int16_t>( count );
+    b->score      = alloc_array<int16_t>( count );
+    b->alive      = alloc_array<int16_t>( count );
+    b->steps      = alloc_array<int16_t>( count );
+    b->from_x     = alloc_array<int16_t>( count );
+    b->from_y     = alloc_array<int16_t>( count );
+    b->hit        = alloc_array<int16_t>( count );
+    b->rng        = alloc_array<uint32_t>( count );
+
+    b->seg_x        = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_y        = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_dir_x    = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_dir_y    = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_start_x  = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_start_y  = alloc_array<int16_t>( count * kMaxSegments );
+    b->seg_count    = alloc_array<uint16_t>( count );
+    b->seg_reader   = alloc_array<uint16_t>( count );
+    b->seg_writer   = alloc_array<uint16_t>( count );
+    b->next_start_x = alloc_array<int16_t>( count );
+    b->next_start_y = alloc_array<int16_t>( count );
+
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        // xorshift must never be seeded with zero
+        b->rng[i] = (seed + i * 0x9E3779B9u) | 1;
+        batch_reset( b, i );
+    }
+
+    return b;
+}
+
+
+void batch_destroy( SnakeBatch* b )
+{
+    if( !b )
+        return;
+
+    free( b->blocked );
+    free( b->head_x );      free( b->head_y );      free( b->head_dir_x );  free( b->head_dir_y );
+    free( b->tail_x );      free( b->tail_y );      free( b->tail_dir_x );  free( b->tail_dir_y );
+    free( b->length );      free( b->counter );     free( b->speed );       free( b->speed_frac );
+    free( b->delay );       free( b->view_col );    free( b->view_row );
+    free( b->apple_x );     free( b->apple_y );     free( b->score );       free( b->alive );
+    free( b->steps );       free( b->from_x );      free( b->from_y );      free( b->hit );
+    free( b->rng );
+    free( b->seg_x );       free( b->seg_y );       free( b->seg_dir_x );   free( b->seg_dir_y );
+    free( b->seg_start_x ); free( b->seg_start_y );
+    free( b->seg_count );   free( b->seg_reader );  free( b->seg_writer );
+    free( b->next_start_x ); free( b->next_start_y );
+    free( b );
+}
+
+
+bool batch_load_level( SnakeBatch* b, const uint8_t* level, size_t size )
+{
+    if( size < kLevelHeaderSize || level[0] != 'S' || level[1] != 'L' || level[2] != 1 )
+        return false;
+
+    uint8_t  tile   = level[3];
+    uint16_t width  = level[4] | level[5] << 8;
+    uint16_t height = level[6] | level[7] << 8;
+    if( !level_fits( tile, width, height ) || size < kLevelHeaderSize + height * sizeof( uint16_t ) )
+        return false;
+
+    // decode the whole map, we have the memory here
+    uint8_t* walls = alloc_array<uint8_t>( width * height );
+    for( uint16_t row = 0; row < height; row++ )
+    {
+        size_t   offset = level[kLevelHeaderSize + row * 2] | level[kLevelHeaderSize + row * 2 + 1] << 8;
+        uint16_t col    = 0;
+        while( col < width && offset < size )
+        {
+            uint8_t  run   = level[offset++];
+            uint16_t count = (run & 0x7F) + 1;
+            for( uint16_t c = col; c < col + count && c < width; c++ )
+                walls[row * width + c] = run >> 7;
+            col += count;
+        }
+    }
+
+    b->tile         = tile;
+    b->map_width    = width;
+    b->map_height   = height;
+    b->board_width  = width * tile / kCellSize;
+    b->board_height = height * tile / kCellSize;
+
+    // bake level_hit_dot() into one byte per board unit
+    free( b->blocked );
+    b->blocked = alloc_array<uint8_t>( b->board_width * b->board_height );
+    for( int16_t y = 0; y < b->board_height; y++ )
+    {
+        for( int16_t x = 0; x < b->board_width; x++ )
+        {
+            static const int8_t kDot[][2] = { { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+            for( int i = 0; i < (kCellSize == 1 ? 5 : 1); i++ )
+            {
+                int16_t px = x + kDot[i][0];
+                int16_t py = y + kDot[i][1];
+                if( px < 0 || py < 0 )
+                    continue;
+
+                uint16_t tile_x = px * kCellSize / tile;
+                uint16_t tile_y = py * kCellSize / tile;
+                if( tile_x < width && tile_y < height && walls[tile_y * width + tile_x] )
+                    b->blocked[y * b->board_width + x] = 1;
+            }
+        }
+    }
+    free( walls );
+
+    for( uint32_t i = 0; i < b->count; i++ )
+        batch_reset( b, i );
+    return true;
+}
+
+
+void batch_reset( SnakeBatch* b, uint32_t game )
+{
+    // same starting state as snake.cpp
+    b->head_x[game]     = kStartingPointX;
+    b->head_y[game]     = kStartingPointY;
+    b->head_dir_x[game] = 0;
+    b->head_dir_y[game] = 1;
+    b->tail_x[game]     = kStartingPointX;
+    b->tail_y[game]     = kStartingPointY;
+    b->tail_dir_x[game] = 0;
+    b->tail_dir_y[game] = 1;
+    b->length[game]     = kStartLength;
+    b->counter[game]    = 0;
+    b->speed[game]      = kStartSpeed;
+    b->speed_frac[game] = 0;
+    b->delay[game]      = kStartDelay;
+    b->view_col[game]   = 0;
+    b->view_row[game]   = 0;
+    b->score[game]      = 0;
+    b->alive[game]      = 1;
+
+    b->seg_count[game]    = 0;
+    b->seg_reader[game]   = 0;
+    b->seg_writer[game]   = 0;
+    b->next_start_x[game] = kStartingPointX;
+    b->next_start_y[game] = kStartingPointY;
+
+    place_apple( b, game );
+}
+
+
+void batch_step( SnakeBatch* b, const uint8_t* actions, int16_t* observations )
+{
+    const uint32_t n = b->count;
+
+    // local unaliased copies of the arrays so the straight loops below vectorize
+    int16_t*  __restrict head_x     = b->head_x;
+    int16_t*  __restrict head_y     = b->head_y;
+    int16_t*  __restrict head_dir_x = b->head_dir_x;
+    int16_t*  __restrict head_dir_y = b->head_dir_y;
+    int16_t*  __restrict tail_x     = b->tail_x;
+    int16_t*  __restrict tail_y     = b->tail_y;
+    uint16_t* __restrict length     = b->length;
+    uint16_t* __restrict counter    = b->counter;
+    uint16_t* __restrict speed      = b->speed;
+    uint16_t* __restrict speed_frac = b->speed_frac;
+    int16_t*  __restrict apple_x    = b->apple_x;
+    int16_t*  __restrict apple_y    = b->apple_y;
+    int16_t*  __restrict alive      = b->alive;
+    int16_t*  __restrict steps      = b->steps;
+    int16_t*  __restrict from_x     = b->from_x;
+    int16_t*  __restrict from_y     = b->from_y;
+    int16_t*  __restrict hit        = b->hit;
+
+    // scroll_view() first, where draw_snake() does it in loop(), the view decides where apples go
+    if( b->tile )
+    {
+        for( uint32_t i = 0; i < n; i++ )
+        {
+            b->view_col[i] = scroll_axis( b, head_x[i] * kCellSize, b->view_col[i], b->map_width, kPanelWidth );
+            b->view_row[i] = scroll_axis( b, head_y[i] * kCellSize, b->view_row[i], b->map_height, kPanelHeight );
+        }
+    }
+
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        if( actions[i] != kActionNone && alive[i] )
+            turn( b, i, actions[i] );
+    }
+
+    // speed and heads, dead games are multiplied out rather than branched around
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        uint16_t frac = speed_frac[i] + speed[i] * alive[i];
+        steps[i]      = frac >> kSpeedShift;
+        speed_frac[i] = frac & ((1 << kSpeedShift) - 1);
+        from_x[i]     = head_x[i];
+        from_y[i]     = head_y[i];
+        head_x[i]    += head_dir_x[i] * steps[i];
+        head_y[i]    += head_dir_y[i] * steps[i];
+    }
+
+    // apples, anywhere along the path like check_for_apple()
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        int16_t min_x = min16( from_x[i], head_x[i] ) - kAppleReach;
+        int16_t max_x = max16( from_x[i], head_x[i] ) + kAppleReach;
+        int16_t min_y = min16( from_y[i], head_y[i] ) - kAppleReach;
+        int16_t max_y = max16( from_y[i], head_y[i] ) + kAppleReach;
+        hit[i] = (steps[i] > 0) & (apple_x[i] >= min_x) & (apple_x[i] <= max_x) & (apple_y[i] >= min_y) & (apple_y[i] <= max_y);
+    }
+
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        if( hit[i] )
+            eat( b, i );
+    }
+
+    // the tail only moves once the snake has grown to its full length, and before the
+    // collision test like in move_snake()
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        if( !steps[i] )
+            continue;
+
+        uint16_t grow = steps[i] < length[i] - counter[i] ? steps[i] : length[i] - counter[i];
+        counter[i] += grow;
+        move_tail( b, i, steps[i] - grow );
+
+        if( head_in_snake( b, i ) || head_in_wall( b, i ) )
+            alive[i] = 0;
+    }
+
+    // boundary_clamp() on both ends
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        int16_t inside = (head_x[i] >= 0) & (head_x[i] < b->board_width) & (head_y[i] >= 0) & (head_y[i] < b->board_height) &
+                         (tail_x[i] >= 0) & (tail_x[i] < b->board_width) & (tail_y[i] >= 0) & (tail_y[i] < b->board_height);
+        alive[i] &= inside;
+    }
+
+    for( uint32_t i = 0; i < n; i++ )
+    {
+        int16_t* __restrict obs = observations + i * kBatchObservationSize;
+        obs[0] = head_x[i];
+        obs[1] = head_y[i];
+        obs[2] = head_dir_x[i];
+        obs[3] = head_dir_y[i];
+        obs[4] = apple_x[i];
+        obs[5] = apple_y[i];
+        obs[6] = b->score[i];
+        obs[7] = alive[i];
+    }
+}
+
+
+// EOF
@@ -0,0 +1,96 @@
+//
+//  snake_batch.h
+//
+//
+//  Host only: steps many snake games in lockstep for tuning and automated play.
+//  The rules are the ones in snake.cpp, the numbers come from snake_rules.h and batch_test
+//  checks that the two agree step for step. Build with -DCELL_GRID for the cell mode.
+//
+
+#ifndef snake_batch_h
+#define snake_batch_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "snake_rules.h"
+
+
+#define kBatchObservationSize  8        // int16_t values per game, see batch_step()
+
+enum
+{
+    kActionNone = 0,
+    kActionLeft,
+    kActionRight,
+    kActionUp,
+    kActionDown
+};
+
+
+// every field below the board is an array with one entry per game (segments have kMaxSegments per game)
+typedef struct
+{
+    uint32_t  count;
+
+    // the board is shared by every game
+    int16_t   board_width;  // in board units, the level's size or the screen's without one
+    int16_t   board_height;
+    uint8_t   tile;         // level tile size in pixels, 0 without a level
+    uint16_t  map_width;    // in tiles
+    uint16_t  map_height;
+    uint8_t*  blocked;      // one byte per board unit, set where a dot would touch a wall (level_hit_dot())
+
+    int16_t*  head_x;
+    int16_t*  head_y;
+    int16_t*  head_dir_x;
+    int16_t*  head_dir_y;
+    int16_t*  tail_x;
+    int16_t*  tail_y;
+    int16_t*  tail_dir_x;
+    int16_t*  tail_dir_y;
+    uint16_t* length;
+    uint16_t* counter;
+    uint16_t* speed;        // fixed point board units per step, see kSpeedShift
+    uint16_t* speed_frac;
+    uint16_t* delay;        // what the game would wait per tick, apples speed the snake up once it bottoms out
+    uint16_t* view_col;     // top left tile on the screen, apples are placed in view
+    uint16_t* view_row;
+
+    int16_t*  apple_x;
+    int16_t*  apple_y;
+    int16_t*  score;
+    int16_t*  alive;        // 1 or 0, kept as a short so it can scale the movement
+    int16_t*  steps;        // scratch: how far the head moves this step
+    int16_t*  from_x;       // scratch: where the head started this step
+    int16_t*  from_y;
+    int16_t*  hit;          // scratch: games that ate an apple this step
+    uint32_t* rng;
+
+    int16_t*  seg_x;
+    int16_t*  seg_y;
+    int16_t*  seg_dir_x;
+    int16_t*  seg_dir_y;
+    int16_t*  seg_start_x;
+    int16_t*  seg_start_y;
+    uint16_t* seg_count;
+    uint16_t* seg_reader;
+    uint16_t* seg_writer;
+    int16_t*  next_start_x; // where the next segment starts
+    int16_t*  next_start_y;
+} SnakeBatch;
+
+
+SnakeBatch* batch_create( uint32_t count, uint32_t seed );
+void        batch_destroy( SnakeBatch* batch );
+void        batch_reset( SnakeBatch* batch, uint32_t game );
+
+// takes a level in the format described at the top of snake.cpp and resets every game on it
+bool        batch_load_level( SnakeBatch* batch, const uint8_t* level, size_t size );
+
+// actions has one kAction per game, observations receives count * kBatchObservationSize values:
+// head x, head y, dir x, dir y, apple x, apple y, score, alive. Dead games stay put until reset.
+void        batch_step( SnakeBatch* batch, const uint8_t* actions, int16_t* observations );
+
+
+#endif /* snake_batch_h */
@@ -0,0 +1,229 @@
+//
+//  st7735_emu.cpp
+//  
+//
+
+#include "st7735_emu.h"
+
+#include <string.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// defaults for the Feather M4: the SAMD51 SPI runs the ST7735 at 24MHz, and each transaction
+// (beginTransaction, CS low/high) and D/C toggle costs a little on top of the bits themselves
+#define kDefaultClock          24000000
+#define kDefaultTransactionUs  1.0
+#define kDefaultCommandUs      0.25
+
+
+PanelStats panel_stats_since( const PanelStats& now, const PanelStats& then )
+{
+    PanelStats stats;
+    stats.transactions = now.transactions - then.transactions;
+    stats.commands     = now.commands - then.commands;
+    stats.data_bytes   = now.data_bytes - then.data_bytes;
+    return stats;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+St7735Emu::St7735Emu() : m_clock( kDefaultClock ), m_transaction_us( kDefaultTransactionUs ), m_command_us( kDefaultCommandUs )
+{
+    reset();
+}
+
+
+void St7735Emu::reset()
+{
+    memset( m_ram, 0, sizeof( m_ram ) );
+    memset( &m_stats, 0, sizeof( m_stats ) );
+    memset( &m_mark, 0, sizeof( m_mark ) );
+    m_command     = ST77XX_NOP;
+    m_param_count = 0;
+    m_have_high   = false;
+    m_madctl      = 0;
+    m_inverted    = false;
+    m_col_start   = m_col = 0;
+    m_row_start   = m_row = 0;
+    m_col_end     = kPanelRamWidth - 1;
+    m_row_end     = kPanelRamHeight - 1;
+}
+
+
+void St7735Emu::begin()
+{
+    ++m_stats.transactions;
+}
+
+
+void St7735Emu::end()
+{
+    // CS high ends any write in progress
+    m_command = ST77XX_NOP;
+}
+
+
+void St7735Emu::command( uint8_t cmd )
+{
+    ++m_stats.commands;
+    m_command     = cmd;
+    m_param_count = 0;
+    m_have_high   = false;
+
+    switch( cmd )
+    {
+        case ST77XX_SWRESET:
+            m_madctl   = 0;
+            m_inverted = false;
+            break;
+
+        case ST77XX_INVON:
+            m_inverted = true;
+            break;
+
+        case ST77XX_INVOFF:
+            m_inverted = false;
+            break;
+
+        case ST77XX_RAMWR:
+            m_col = m_col_start;
+            m_row = m_row_start;
+            break;
+    }
+}
+
+
+void St7735Emu::data( uint8_t value )
+{
+    ++m_stats.data_bytes;
+
+    if( m_command != ST77XX_RAMWR )
+    {
+        parameter( value );
+        return;
+    }
+
+    if( !m_have_high )
+    {
+        m_high_byte = value;
+        m_have_high = true;
+        return;
+    }
+
+    m_have_high = false;
+    write_pixel( (m_high_byte << 8) | value );
+}
+
+
+void St7735Emu::data16( uint16_t value, uint32_t count )
+{
+    if( m_command != ST77XX_RAMWR || m_have_high )
+    {
+        for( uint32_t i = 0; i < count; i++ )
+        {
+            data( value >> 8 );
+            data( value & 0xFF );
+        }
+        return;
+    }
+
+    m_stats.data_bytes += count * 2;
+    for( uint32_t i = 0; i < count; i++ )
+        write_pixel( value );
+}
+
+
+void St7735Emu::parameter( uint8_t value )
+{
+    if( m_param_count < sizeof( m_params ) )
+        m_params[m_param_count++] = value;
+
+    switch( m_command )
+    {
+        case ST77XX_CASET:
+            if( m_param_count == 4 )
+            {
+                m_col_start = (m_params[0] << 8) | m_params[1];
+                m_col_end   = (m_params[2] << 8) | m_params[3];
+            }
+            break;
+
+        case ST77XX_RASET:
+            if( m_param_count == 4 )
+            {
+                m_row_start = (m_params[0] << 8) | m_params[1];
+                m_row_end   = (m_params[2] << 8) | m_params[3];
+            }
+            break;
+
+        case ST77XX_MADCTL:
+            m_madctl = value;
+            break;
+    }
+}
+
+
+uint16_t* St7735Emu::ram_at( uint16_t col, uint16_t row )
+{
+    // MV swaps the address counters, MX and MY mirror them on the frame memory
+    uint16_t x = (m_madctl & ST77XX_MADCTL_MV) ? row : col;
+    uint16_t y = (m_madctl & ST77XX_MADCTL_MV) ? col : row;
+    if( x >= kPanelRamWidth || y >= kPanelRamHeight )
+        return NULL;
+
+    if( m_madctl & ST77XX_MADCTL_MX )
+        x = kPanelRamWidth - 1 - x;
+    if( m_madctl & ST77XX_MADCTL_MY )
+        y = kPanelRamHeight - 1 - y;
+
+    return &m_ram[y][x];
+}
+
+
+void St7735Emu::write_pixel( uint16_t color )
+{
+    uint16_t* ram = ram_at( m_col, m_row );
+    if( ram )
+        *ram = color;
+
+    // the window wraps column first, then row, then back to the top
+    if( m_col++ >= m_col_end )
+    {
+        m_col = m_col_start;
+        if( m_row++ >= m_row_end )
+            m_row = m_row_start;
+    }
+}
+
+
+uint16_t St7735Emu::pixel( uint16_t col, uint16_t row ) const
+{
+    uint16_t* ram = const_cast<St7735Emu*>( this )->ram_at( col, row );
+    return ram ? *ram : 0;
+}
+
+
+#pragma mark -
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double St7735Emu::time_us( const PanelStats& stats ) const
+{
+    // every command and data byte is 8 clocks, plus the fixed costs around them
+    double bits = (stats.commands + stats.data_bytes) * 8.0;
+    return bits * 1000000.0 / m_clock + stats.transactions * m_transaction_us + stats.commands * m_command_us;
+}
+
+
+void St7735Emu::set_overhead( double transaction_us, double command_us )
+{
+    m_transaction_us = transaction_us;
+    m_command_us     = command_us;
+}
+
+
+// EOF
@@ -0,0 +1,103 @@
+//
+//  st7735_emu.h
+//  
+//
+//  Host only: a model of the ST7735 controller as driven by Adafruit_ST7735. It keeps the
+//  panel RAM, follows CASET/RASET/RAMWR/MADCTL/INVON/INVOFF and counts what went over the
+//  wire so rendering can be scored in bytes and estimated time at a given SPI clock.
+//
+
+#ifndef st7735_emu_h
+#define st7735_emu_h
+
+#include <stdint.h>
+
+
+#define kPanelRamWidth   132      // ST7735S frame memory
+#define kPanelRamHeight  162
+
+#define ST77XX_NOP       0x00
+#define ST77XX_SWRESET   0x01
+#define ST77XX_SLPOUT    0x11
+#define ST77XX_NORON     0x13
+#define ST77XX_INVOFF    0x20
+#define ST77XX_INVON     0x21
+#define ST77XX_DISPON    0x29
+#define ST77XX_CASET     0x2A
+#define ST77XX_RASET     0x2B
+#define ST77XX_RAMWR     0x2C
+#define ST77XX_MADCTL    0x36
+#define ST77XX_COLMOD    0x3A
+
+#define ST77XX_MADCTL_MY  0x80
+#define ST77XX_MADCTL_MX  0x40
+#define ST77XX_MADCTL_MV  0x20
+#define ST77XX_MADCTL_RGB 0x00
+
+
+typedef struct
+{
+    uint32_t transactions;    // chip select low to high
+    uint32_t commands;        // command bytes, each one is a D/C toggle
+    uint64_t data_bytes;
+} PanelStats;
+
+
+PanelStats panel_stats_since( const PanelStats& now, const PanelStats& then );
+
+
+class St7735Emu
+{
+public:
+    St7735Emu();
+
+    void     reset();
+
+    // the wire
+    void     begin();
+    void     end();
+    void     command( uint8_t cmd );
+    void     data( uint8_t value );
+    void     data16( uint16_t value, uint32_t count );   // the same 16 bit word count times, big endian
+
+    // the glass
+    uint16_t pixel( uint16_t col, uint16_t row ) const;  // in the current (MADCTL) address space
+    bool     inverted() const { return m_inverted; }
+    uint8_t  madctl() const   { return m_madctl; }
+
+    // the cost model
+    PanelStats stats() const  { return m_stats; }
+    PanelStats marked() const { return m_mark; }
+    PanelStats since_mark() const                       { return panel_stats_since( m_stats, m_mark ); }
+    void     mark()                                     { m_mark = m_stats; }
+    void     mark( const PanelStats& stats )            { m_mark = stats; }
+    double   time_us( const PanelStats& stats ) const;
+    void     set_clock( uint32_t hz )                    { m_clock = hz; }
+    void     set_overhead( double transaction_us, double command_us );
+
+private:
+    uint16_t* ram_at( uint16_t col, uint16_t row );
+    void     parameter( uint8_t value );
+    void     write_pixel( uint16_t color );
+
+    uint16_t m_ram[kPanelRamHeight][kPanelRamWidth];
+    uint8_t  m_command;
+    uint8_t  m_params[4];
+    uint8_t  m_param_count;
+    uint8_t  m_high_byte;     // first half of a pixel written one byte at a time
+    bool     m_have_high;
+
+    uint8_t  m_madctl;
+    bool     m_inverted;
+    uint16_t m_col_start, m_col_end, m_row_start, m_row_end;
+    uint16_t m_col, m_row;
+
+    PanelStats m_stats;
+    PanelStats m_mark;        // where the harness started counting
+    uint32_t m_clock;
+    double   m_transaction_us;
+    double   m_command_us;
+};
+
+
+#endif /* st7735_emu_h */
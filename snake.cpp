@@ -16,10 +16,17 @@
 // this controls whether or not we use the FatFS file system on the flash device.
 #define FLASH_FS
 
+// time redrawing the snake from its segments against replaying it dot by dot, printed when pausing
+//#define BENCHMARK_REDRAW
+
+// run the game on a grid of 4x4 pixel cells instead of single pixels
+//#define CELL_GRID
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "snake.h"
+#include "snake_rules.h"
 
 #ifdef FLASH_FS
 #include <Adafruit_SPIFlash_FatFs.h>
@@ -44,14 +51,18 @@
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#define kMinDelay      5 
-#define kLineWidth     3             
-#define kLineTolerance (kLineWidth + 2)   // line width is 3 plus one pixel on each side
-#define kMaxSegments  100
 #define kScreenWidth  tft.width() 
 #define kScreenHeight tft.height()
-#define kStartingPointX  80
-#define kStartingPointY  40
+
+#define kChunkTiles        8              // level chunks are 8x8 tiles, one byte per row
+#define kChunkSlots        8              // how many chunks we keep decoded at once
+#define kLevelBufferSize   32             // streaming read buffer for level data
+#define kLevelHeaderSize   8
+#define kLevelFlashBase    0x1000         // raw flash layout: high score lives in the first sector
+#define kLevelFlashStride  0x1000         // each level gets its own 4K sector
+#define kNoChunk           0xFFFF
+
+#define kStorageIdleTime   1000           // ms the title screen sits untouched before we mount the flash
 
 
 #pragma mark -
@@ -61,40 +72,95 @@
 typedef struct
 {
     // used by the eraser
-    int16_t  x;         // position of where this segment turns
-    int16_t  y;
-    int16_t  dir_x;     // the turn we will take
-    int16_t  dir_y;
+    coord_t  x;         // position of where this segment turns
+    coord_t  y;
+    coord_t  dir_x;     // the turn we will take
+    coord_t  dir_y;
 
     // mostly used for collision
-    int16_t  start_x;   // position of where this segment starts
-    int16_t  start_y;
+    coord_t  start_x;   // position of where this segment starts
+    coord_t  start_y;
     uint16_t length;    // how long it is...only used for snake draw
 } Segment;
 
 
+// Levels are stored on the flash as run-length encoded tile rows:
+//
+//   0  'S' 'L'              magic
+//   2  uint8_t  version     currently 1
+//   3  uint8_t  tile        tile size in pixels
+//   4  uint16_t width       in tiles (little endian)
+//   6  uint16_t height      in tiles
+//   8  uint16_t rows[height]  offset of each row's runs from the start of the level
+//   .. runs                 one byte each: bit 7 set for wall, bits 0-6 are the run length - 1
+//
+// The map is never copied into RAM; rows are streamed straight to the display when the level
+// is drawn and decoded on demand into a small cache of 8x8 tile chunks for collision.
+// Maps can be bigger than the screen, the view then follows the head a tile at a time. Board
+// coordinates are always map coordinates (with CELL_GRID they have to fit in a coord_t).
+typedef struct
+{
+    uint32_t base;      // flash address of the level (unused with the file system)
+    uint16_t width;     // in tiles
+    uint16_t height;
+    uint8_t  tile;      // tile size in pixels
+    bool     loaded;
+} Level;
+
+
+typedef struct
+{
+    uint16_t key;       // chunk index in the map, kNoChunk if this slot is empty
+    uint16_t stamp;     // last time this chunk was used, for eviction
+    uint8_t  rows[kChunkTiles];
+} LevelChunk;
+
+
 #pragma mark -
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static Segment snake_draw  = { kStartingPointX, kStartingPointY, 0, 1, 0, 0, 10 };    
+static Segment snake_draw  = { kStartingPointX, kStartingPointY, 0, 1, 0, 0, kStartLength };    
 static Segment snake_erase = { kStartingPointX, kStartingPointY, 0, 1, 0, 0, 1 };    
 
-static int16_t  seg_start_x = kStartingPointX;
-static int16_t  seg_start_y = kStartingPointY;
+static coord_t  seg_start_x = kStartingPointX;
+static coord_t  seg_start_y = kStartingPointY;
 
-static int16_t  apple_x      = 0;
-static int16_t  apple_y      = 0;
+static coord_t  apple_x      = 0;
+static coord_t  apple_y      = 0;
 static int16_t  s_score      = 0;
-static uint16_t s_delayTime  = 40;       // this gets shorter as the levels get higher
+static uint16_t s_delayTime  = kStartDelay;
 static bool     s_paused     = false;
 static uint16_t s_counter    = 0;
+static uint16_t s_speed      = kStartSpeed;  // once the delay bottoms out the snake moves further per tick
+static uint16_t s_speed_frac = 0;
+static bool     s_tail_moving = false;   // set once the eraser starts following the head
+static coord_t  s_tail_from_x = 0;       // where the eraser was a step ago
+static coord_t  s_tail_from_y = 0;
+
+static bool     s_storage_tried   = false;  // the flash is mounted lazily so it doesn't hold up booting
+static uint32_t s_title_shown     = 0;      // when the title screen went up, in ms
+static bool     s_storage_mounted = false;
+static bool     s_best_score_read = false;
+static int16_t  s_best_score      = 0;      // cached high score, valid once s_best_score_read is set
+
+static coord_t  s_drawn_x    = kStartingPointX;  // where the head was when we last drew it
+static coord_t  s_drawn_y    = kStartingPointY;
 
 static uint16_t s_segment_count  = 0;
 static uint16_t s_segment_writer = 0;
 static uint16_t s_segment_reader = 0;
 static Segment  s_segments[kMaxSegments];
 
+static Level      s_level;
+static LevelChunk s_level_chunks[kChunkSlots];
+static uint16_t   s_level_stamp       = 0;
+static uint8_t    s_level_buffer[kLevelBufferSize];
+static uint32_t   s_level_buffer_pos  = 0;
+static uint8_t    s_level_buffer_len  = 0;
+static uint16_t   s_view_col          = 0;    // top left tile of the map that is on screen
+static uint16_t   s_view_row          = 0;
+
 static Adafruit_ST7735 tft = Adafruit_ST7735( TFT_CS,  TFT_DC, TFT_RST );
 
 #ifdef FLASH_FS
@@ -103,20 +169,37 @@ static Adafruit_W25Q16BV_FatFs fatfs( flash );
 static uint8_t s_high_score[512]; // we only make a short out of this whole buffer
 #endif
 
+#ifdef FLASH_FS
+static File s_level_file;
+#endif
+
 
 #pragma mark -
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void check_for_apple();
+void check_for_apple( int16_t from_x, int16_t from_y );
 void place_apple();
 bool apple_in_segment();
 void check_for_direction_change();
 void boundary_clamp( Segment* );
-void erase_snake();
+bool level_hit( int16_t x, int16_t y );
+bool level_hit_dot( int16_t x, int16_t y );
+void draw_level();
+int16_t board_width();
+int16_t board_height();
+bool scroll_view();
+void move_eraser( uint16_t steps );
 void draw_segments();
-bool snake_in_segment();
+void draw_apple();
+void redraw_snake();
+void restore_board();
+#ifdef BENCHMARK_REDRAW
+void benchmark_redraw();
+#endif
+bool snake_in_segment( int16_t from_x, int16_t from_y );
 void print_error( const char* error );
+bool mount_storage();
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -125,7 +208,7 @@ void print_error( const char* error );
 
 #ifdef FLASH_FS
 
-int16_t get_high_score()
+int16_t read_high_score()
 {
   File readFile = fatfs.open( "highscore", FILE_READ );
   if( !readFile )
@@ -141,7 +224,7 @@ int16_t get_high_score()
   return score;
 }
 
-void set_high_score( int16_t score )
+void write_high_score( int16_t score )
 {
   File writeFile = fatfs.open( "highscore", FILE_WRITE );
   if( !writeFile )
@@ -158,13 +241,13 @@ void set_high_score( int16_t score )
 
 #else
 
-int16_t get_high_score()
+int16_t read_high_score()
 {
     flash.readMemory( 0, s_high_score, sizeof( s_high_score ) );
     return *((int16_t*)&s_high_score);
 }
 
-void set_high_score( int16_t score )
+void write_high_score( int16_t score )
 {
     *((int16_t*)&s_high_score) = score;
     flash.writeMemory( 0, s_high_score, sizeof( s_high_score ) );
@@ -173,6 +256,332 @@ void set_high_score( int16_t score )
 #endif // FLASH_FS
 
 
+int16_t get_high_score()
+{
+    if( !s_best_score_read )
+    {
+        // erased flash reads back as -1
+        s_best_score_read = true;
+        s_best_score      = mount_storage() ? max( read_high_score(), (int16_t)0 ) : 0;
+    }
+
+    return s_best_score;
+}
+
+
+void set_high_score( int16_t score )
+{
+    s_best_score      = score;
+    s_best_score_read = true;
+    if( mount_storage() )
+        write_high_score( score );
+}
+
+
+#pragma mark -
+
+#ifdef FLASH_FS
+
+bool open_level( uint8_t level )
+{
+    char name[16];
+    snprintf( name, sizeof( name ), "level%d", level );
+
+    if( s_level_file )
+        s_level_file.close();
+
+    s_level_file = fatfs.open( name, FILE_READ );
+    s_level.base = 0;
+    if( !s_level_file )
+        return false;
+
+    return true;
+}
+
+uint16_t level_read( uint32_t offset, uint8_t* buffer, uint16_t size )
+{
+    // how many bytes we got, fewer than asked for near the end of the file
+    if( !s_level_file || !s_level_file.seek( offset ) )
+        return 0;
+
+    int read = s_level_file.read( buffer, size );
+    return read > 0 ? read : 0;
+}
+
+#else
+
+bool open_level( uint8_t level )
+{
+    s_level.base = kLevelFlashBase + (uint32_t)(level - 1) * kLevelFlashStride;
+    return true;
+}
+
+uint16_t level_read( uint32_t offset, uint8_t* buffer, uint16_t size )
+{
+    return flash.readMemory( s_level.base + offset, buffer, size ) ? size : 0;
+}
+
+#endif // FLASH_FS
+
+
+uint8_t level_read_byte( uint32_t offset )
+{
+    // refill the buffer if we stepped outside of it, reads are mostly sequential
+    if( offset < s_level_buffer_pos || offset >= s_level_buffer_pos + s_level_buffer_len )
+    {
+        // a short read at the end of the level keeps what it got
+        s_level_buffer_pos = offset;
+        s_level_buffer_len = level_read( offset, s_level_buffer, kLevelBufferSize );
+        if( !s_level_buffer_len )
+            return 0;
+    }
+
+    return s_level_buffer[offset - s_level_buffer_pos];
+}
+
+
+uint16_t level_read_short( uint32_t offset )
+{
+    return level_read_byte( offset ) | (level_read_byte( offset + 1 ) << 8);
+}
+
+
+uint32_t level_row_offset( uint16_t row )
+{
+    return level_read_short( kLevelHeaderSize + row * sizeof( uint16_t ) );
+}
+
+
+bool load_level( uint8_t level )
+{
+    uint32_t start = micros();
+
+    s_level.loaded     = false;
+    s_level_buffer_len = 0;
+    s_view_col         = 0;
+    s_view_row         = 0;
+    for( int i = 0; i < kChunkSlots; i++ )
+        s_level_chunks[i].key = kNoChunk;
+
+    // no level on the flash just means an empty playfield
+    if( !mount_storage() || !open_level( level ) || level_read_byte( 0 ) != 'S' || level_read_byte( 1 ) != 'L' || level_read_byte( 2 ) != 1 )
+        return false;
+
+    s_level.tile   = level_read_byte( 3 );
+    s_level.width  = level_read_short( 4 );
+    s_level.height = level_read_short( 6 );
+    if( !level_fits( s_level.tile, s_level.width, s_level.height ) )
+    {
+        Serial.println( "Level doesn't fit the board" );
+        return false;
+    }
+
+    s_level.loaded = true;
+    draw_level();
+
+    Serial.print( "Level " );
+    Serial.print( level );
+    Serial.print( " loaded in " );
+    Serial.print( micros() - start );
+    Serial.print( " us, " );
+#ifdef FLASH_FS
+    Serial.print( sizeof( s_level ) + sizeof( s_level_chunks ) + sizeof( s_level_buffer ) + sizeof( s_level_file ) );
+#else
+    Serial.print( sizeof( s_level ) + sizeof( s_level_chunks ) + sizeof( s_level_buffer ) );
+#endif
+    Serial.println( " bytes of RAM" );
+    return true;
+}
+
+
+void draw_level()
+{
+    if( !s_level.loaded )
+        return;
+
+    // stream the runs straight to the display, only the rows and columns in view are drawn
+    uint16_t last_row = min( s_level.height, (uint16_t)(s_view_row + (kScreenHeight + s_level.tile - 1) / s_level.tile) );
+    uint16_t last_col = min( s_level.width, (uint16_t)(s_view_col + (kScreenWidth + s_level.tile - 1) / s_level.tile) );
+    for( uint16_t row = s_view_row; row < last_row; row++ )
+    {
+        uint32_t offset = level_row_offset( row );
+        uint16_t col    = 0;
+        while( col < last_col )
+        {
+            uint8_t  run   = level_read_byte( offset++ );
+            uint16_t count = (run & 0x7F) + 1;
+            if( (run & 0x80) && col + count > s_view_col )
+            {
+                uint16_t from = max( col, s_view_col );
+                uint16_t to   = min( (uint16_t)(col + count), last_col );
+                tft.fillRect( (from - s_view_col) * s_level.tile, (row - s_view_row) * s_level.tile, (to - from) * s_level.tile, s_level.tile, ST77XX_MAGENTA );
+            }
+            col += count;
+        }
+    }
+}
+
+
+int16_t view_left()
+{
+    // in pixels, the view only moves when there is a level so the tile size is valid
+    return s_view_col * s_level.tile;
+}
+
+
+int16_t view_top()
+{
+    return s_view_row * s_level.tile;
+}
+
+
+int16_t board_width()
+{
+    // without a level the screen is the whole board
+    if( s_level.loaded )
+        return s_level.width * s_level.tile / kCellSize;
+    return kScreenWidth / kCellSize;
+}
+
+
+int16_t board_height()
+{
+    if( s_level.loaded )
+        return s_level.height * s_level.tile / kCellSize;
+    return kScreenHeight / kCellSize;
+}
+
+
+uint16_t scroll_axis( int16_t head, uint16_t view, uint16_t tiles, int16_t screen )
+{
+    // head and screen are in pixels, view and tiles in tiles. Leave the view alone until the head
+    // gets near an edge, then centre it on the head as far as the map allows
+    int16_t on_screen = head - view * s_level.tile;
+    if( on_screen >= kScrollMargin && on_screen < screen - kScrollMargin )
+        return view;
+
+    uint16_t visible = screen / s_level.tile;
+    if( tiles <= visible )
+        return 0;
+
+    int16_t centre = (head - screen / 2) / s_level.tile;
+    return constrain( centre, 0, tiles - visible );
+}
+
+
+bool scroll_view()
+{
+    if( !s_level.loaded )
+        return false;
+
+    uint16_t col = scroll_axis( snake_draw.x * kCellSize, s_view_col, s_level.width, kScreenWidth );
+    uint16_t row = scroll_axis( snake_draw.y * kCellSize, s_view_row, s_level.height, kScreenHeight );
+    if( col == s_view_col && row == s_view_row )
+        return false;
+
+    s_view_col = col;
+    s_view_row = row;
+    return true;
+}
+
+
+LevelChunk* load_level_chunk( uint16_t chunk_x, uint16_t chunk_y )
+{
+    uint16_t key = chunk_y * ((s_level.width + kChunkTiles - 1) / kChunkTiles) + chunk_x;
+
+    // see if we already have it, otherwise take an empty slot or evict the one used longest ago
+    LevelChunk* slot = NULL;
+    for( int i = 0; i < kChunkSlots; i++ )
+    {
+        LevelChunk* chunk = &s_level_chunks[i];
+        if( chunk->key == key )
+        {
+            chunk->stamp = ++s_level_stamp;
+            return chunk;
+        }
+
+        if( !slot || (slot->key != kNoChunk && (chunk->key == kNoChunk || (uint16_t)(s_level_stamp - chunk->stamp) > (uint16_t)(s_level_stamp - slot->stamp))) )
+            slot = chunk;
+    }
+
+    slot->key   = key;
+    slot->stamp = ++s_level_stamp;
+
+    uint16_t first_col = chunk_x * kChunkTiles;
+    for( uint16_t i = 0; i < kChunkTiles; i++ )
+    {
+        uint16_t row = chunk_y * kChunkTiles + i;
+        slot->rows[i] = 0;
+        if( row >= s_level.height )
+            continue;
+
+        // walk the runs of this row until we are past the chunk
+        uint32_t offset = level_row_offset( row );
+        uint16_t col    = 0;
+        while( col < s_level.width && col < first_col + kChunkTiles )
+        {
+            uint8_t  run   = level_read_byte( offset++ );
+            uint16_t count = (run & 0x7F) + 1;
+            if( run & 0x80 )
+            {
+                for( uint16_t c = max( col, first_col ); c < col + count && c < first_col + kChunkTiles; c++ )
+                    slot->rows[i] |= 1 << (c - first_col);
+            }
+            col += count;
+        }
+    }
+
+    return slot;
+}
+
+
+bool level_hit( int16_t x, int16_t y )
+{
+    if( !s_level.loaded || x < 0 || y < 0 )
+        return false;
+
+    // board coordinates, cells line up with tiles since load_level() only takes whole cells per tile
+    uint16_t tile_x = x * kCellSize / s_level.tile;
+    uint16_t tile_y = y * kCellSize / s_level.tile;
+    if( tile_x >= s_level.width || tile_y >= s_level.height )
+        return false;
+
+    LevelChunk* chunk = load_level_chunk( tile_x / kChunkTiles, tile_y / kChunkTiles );
+    return chunk->rows[tile_y % kChunkTiles] & (1 << (tile_x % kChunkTiles));
+}
+
+
+bool level_hit_dot( int16_t x, int16_t y )
+{
+    // a dot reaches a pixel out from its centre, anything less and the eraser would take bites out of the walls
+#ifdef CELL_GRID
+    return level_hit( x, y );
+#else
+    return level_hit( x, y ) || level_hit( x - 1, y ) || level_hit( x + 1, y ) || level_hit( x, y - 1 ) || level_hit( x, y + 1 );
+#endif
+}
+
+
+bool level_in_path( int16_t from_x, int16_t from_y, int16_t to_x, int16_t to_y )
+{
+    if( !s_level.loaded )
+        return false;
+
+    // the head only covers a few pixels per tick so just look at each one
+    int16_t dir_x = (to_x > from_x) - (to_x < from_x);
+    int16_t dir_y = (to_y > from_y) - (to_y < from_y);
+    while( from_x != to_x || from_y != to_y )
+    {
+        from_x += dir_x;
+        from_y += dir_y;
+        if( level_hit_dot( from_x, from_y ) )
+            return true;
+    }
+
+    return false;
+}
+
+
 bool nearly_equals( int16_t p1, int16_t p2, int16_t errorTolerance )
 {
     return abs( p1 - p2 ) <= errorTolerance && abs( p1 - p2 ) <= errorTolerance;
@@ -207,6 +616,36 @@ bool dot_in_segment( int16_t x, int16_t y, Segment* seg, int16_t tolerance )
 }
 
 
+bool span_in_segment( int16_t min_x, int16_t min_y, int16_t max_x, int16_t max_y, Segment* seg )
+{
+    // same test as dot_in_segment() with no tolerance, but for every point of an axis aligned span at once.
+    // The segment covers what is between its start and its turn, in cell mode the turn cell too, so a
+    // segment one pixel long covers nothing at all.
+    if( seg->x == seg->start_x )
+    {
+        // line is vertical -- the span has to cross its column and overlap the inside of the segment
+        if( seg->x >= min_x && seg->x <= max_x )
+        {
+            int16_t lo = seg->start_y < seg->y ? seg->start_y + 1 : seg->y + 1 - kTurnCell;
+            int16_t hi = seg->start_y < seg->y ? seg->y - 1 + kTurnCell : seg->start_y - 1;
+            return lo <= hi && min_y <= hi && max_y >= lo;
+        }
+    }
+    else
+    {
+        // horizontal
+        if( seg->y >= min_y && seg->y <= max_y )
+        {
+            int16_t lo = seg->start_x < seg->x ? seg->start_x + 1 : seg->x + 1 - kTurnCell;
+            int16_t hi = seg->start_x < seg->x ? seg->x - 1 + kTurnCell : seg->start_x - 1;
+            return lo <= hi && min_x <= hi && max_x >= lo;
+        }
+    }
+
+    return false;
+}
+
+
 void draw_grid( uint16_t color1, uint16_t color2 ) 
 {
   tft.fillScreen( ST77XX_BLACK );
@@ -222,12 +661,34 @@ void draw_grid( uint16_t color1, uint16_t color2 )
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void boot_mark( const char* phase )
+{
+    Serial.print( "boot: " );
+    Serial.print( phase );
+    Serial.print( " @ " );
+    Serial.print( millis() );
+    Serial.println( " ms" );
+}
+
+
 bool initialize_graphics() 
 {
   // Use this initializer (uncomment) if you're using a 0.96" 180x60 TFT
   tft.initR( INITR_MINI160x80 );   // initialize a ST7735S chip, mini display
   tft.setRotation( 3 );
   tft.fillScreen( ST77XX_BLACK );
+
+  // the flash gets mounted later, either when we are idle on the title screen or on first use
+  return true;
+}
+
+
+bool mount_storage()
+{
+  if( s_storage_tried )
+    return s_storage_mounted;
+
+  s_storage_tried = true;
   if( !flash.begin() )
     Serial.println( "Could not find flash on QSPI bus!" );
 
@@ -274,16 +735,43 @@ bool initialize_graphics()
 #endif  // ERASE_FLASH     
 #endif  // FLASH_FS
   
+  s_storage_mounted = true;
+  boot_mark( "storage mounted" );
   return true;
 }
 
 
+void service_storage()
+{
+  // called while we are waiting on the player, this is where the mount and high score load usually happen.
+  // The mount blocks, so a player who starts right away doesn't wait on it until the game loads its level
+  if( millis() - s_title_shown < kStorageIdleTime )
+    return;
+
+  get_high_score();
+}
+
+
 Adafruit_ST7735* get_tft()
 {
     return &tft;
 }
 
 
+uint16_t get_cell_size()
+{
+    return kCellSize;
+}
+
+
+uint16_t get_board_memory()
+{
+    // the game state proper: both ends of the snake, its turns and the apple
+    return sizeof( snake_draw ) + sizeof( snake_erase ) + sizeof( s_segments ) + sizeof( seg_start_x ) + sizeof( seg_start_y ) +
+           sizeof( apple_x ) + sizeof( apple_y );
+}
+
+
 void print_error( const char* error )
 {
   tft.setCursor(0, 0);
@@ -300,6 +788,7 @@ void start_game()
 {  
   tft.fillScreen( ST77XX_BLACK );
 //  draw_grid( 0x1111, 0x1111 );        // !!@ debug
+  load_level( 1 );
   place_apple();
 }
 
@@ -307,7 +796,19 @@ void start_game()
 void pause()
 {
     s_paused = !s_paused;
-//    tft.println( s_paused ? "paused" : "running" );
+    if( s_paused )
+    {
+#ifdef BENCHMARK_REDRAW
+        benchmark_redraw();
+#endif
+        tft.setCursor( 62, 36 );
+        tft.setTextColor( ST77XX_WHITE );
+        tft.setTextSize( 1 );
+        tft.print( "paused" );
+    }
+    else
+        restore_board();
+
     delay( 25 );
 }
 
@@ -355,6 +856,9 @@ void game_over()
 #endif
 
     // !!@ we should wait for buttons here to restart the game rather than use the RESET line
+#ifdef SNAKE_EMULATOR
+    emulator_halt();    // back to the host harness
+#endif
     while( 1 )
       ;
 }
@@ -363,7 +867,7 @@ void game_over()
 #pragma mark -
 
 
-void draw_intro()
+void draw_intro( bool (*skip)() )
 {
   tft.setTextWrap( false );
   tft.setCursor(0, 0);
@@ -375,8 +879,14 @@ void draw_intro()
   tft.setTextColor(ST77XX_YELLOW);
   tft.setTextSize(2);
   tft.println("Far Out Labs");
+  boot_mark( "first frame" );
+
+  // hold the splash for a bit unless a key gets pressed, the flash waits for the title screen
+  // since mounting it can't be cut short
+  uint32_t start = millis();
+  while( millis() - start < 850 && !(skip && skip()) )
+    delay( 10 );
 
-  delay( 850 );
   tft.fillScreen( ST77XX_BLACK );
 
   // now draw the press any key to start text
@@ -389,28 +899,157 @@ void draw_intro()
   tft.setTextColor( ST77XX_YELLOW );
   tft.setTextSize( 1 );
   tft.println("Press any key to start");
+  s_title_shown = millis();
 }
 
 
 void draw_dot( int16_t x_pos, int16_t y_pos, uint16_t color )
 {
-    tft.fillCircle( x_pos, y_pos, 1, color );
+#ifdef CELL_GRID
+    tft.fillRect( x_pos * kCellSize - view_left(), y_pos * kCellSize - view_top(), kCellSize, kCellSize, color );
+#else
+    tft.fillCircle( x_pos - view_left(), y_pos - view_top(), 1, color );
+#endif
 }
 
 
-void draw_snake()
+void write_span( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color )
 {
-    draw_dot( snake_draw.x, snake_draw.y, ST77XX_GREEN );
-    erase_snake();
+    // covers the same pixels as a draw_dot() at every point of the (axis aligned) span,
+    // the caller has to wrap this in startWrite()/endWrite()
+    int16_t min_x = min( x0, x1 ) * kCellSize - view_left();
+    int16_t min_y = min( y0, y1 ) * kCellSize - view_top();
+    int16_t width  = abs( x1 - x0 ) + 1;
+    int16_t height = abs( y1 - y0 ) + 1;
+
+#ifdef CELL_GRID
+    tft.writeFillRect( min_x, min_y, width * kCellSize, height * kCellSize, color );
+#else
+    if( height == 1 )
+    {
+        tft.writeFillRect( min_x, min_y - 1, width, 3, color );
+        tft.writeFastHLine( min_x - 1, min_y, width + 2, color );
+    }
+    else
+    {
+        tft.writeFillRect( min_x - 1, min_y, 3, height, color );
+        tft.writeFastVLine( min_x, min_y - 1, height + 2, color );
+    }
+#endif
 }
 
 
-void erase_snake()
+void draw_span( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color )
 {
-    if( s_counter < snake_draw.length )
+    tft.startWrite();
+    write_span( x0, y0, x1, y1, color );
+    tft.endWrite();
+}
+
+
+void redraw_snake()
+{
+    // two rects per segment in a single transaction, so this costs the number of turns, not the length
+    tft.startWrite();
+    for( int i = 0; i < s_segment_count; i++ )
+    {
+        // first segment is at reader index
+        int index = (s_segment_reader + i) % kMaxSegments;
+        write_span( s_segments[index].start_x, s_segments[index].start_y, s_segments[index].x, s_segments[index].y, ST77XX_GREEN );
+    }
+
+    // and the part since the last turn, which isn't a segment yet
+    if( s_segment_count )
+        write_span( seg_start_x, seg_start_y, snake_draw.x, snake_draw.y, ST77XX_GREEN );
+    else
+        write_span( snake_erase.x, snake_erase.y, snake_draw.x, snake_draw.y, ST77XX_GREEN );
+
+    // the eraser clears a whole dot where it stops, which bites into the end of the body, and right
+    // on a turn the dot before that took the inside corner of the next leg. Do the same so a restored
+    // board looks just like the one drawn a tick at a time
+    if( s_tail_moving )
+    {
+        write_span( snake_erase.x, snake_erase.y, snake_erase.x, snake_erase.y, ST77XX_BLACK );
+#ifndef CELL_GRID
+        tft.writePixel( s_tail_from_x + snake_erase.dir_x - view_left(), s_tail_from_y + snake_erase.dir_y - view_top(), ST77XX_BLACK );
+#endif
+    }
+    tft.endWrite();
+
+    s_drawn_x = snake_draw.x;
+    s_drawn_y = snake_draw.y;
+}
+
+
+void restore_board()
+{
+    tft.fillScreen( ST77XX_BLACK );
+    draw_level();
+    redraw_snake();
+    draw_apple();
+}
+
+
+#ifdef BENCHMARK_REDRAW
+
+void replay_span( int16_t x0, int16_t y0, int16_t x1, int16_t y1 )
+{
+    // what it would take to rebuild the snake the way it was drawn, one dot per pixel
+    int16_t dir_x = (x1 > x0) - (x1 < x0);
+    int16_t dir_y = (y1 > y0) - (y1 < y0);
+    draw_dot( x0, y0, ST77XX_GREEN );
+    while( x0 != x1 || y0 != y1 )
+    {
+        x0 += dir_x;
+        y0 += dir_y;
+        draw_dot( x0, y0, ST77XX_GREEN );
+    }
+}
+
+
+void benchmark_redraw()
+{
+    uint32_t start = micros();
+    for( int i = 0; i < s_segment_count; i++ )
+    {
+        int index = (s_segment_reader + i) % kMaxSegments;
+        replay_span( s_segments[index].start_x, s_segments[index].start_y, s_segments[index].x, s_segments[index].y );
+    }
+    if( s_segment_count )
+        replay_span( seg_start_x, seg_start_y, snake_draw.x, snake_draw.y );
+    else
+        replay_span( snake_erase.x, snake_erase.y, snake_draw.x, snake_draw.y );
+    uint32_t replay = micros() - start;
+
+    start = micros();
+    redraw_snake();
+    uint32_t redraw = micros() - start;
+
+    Serial.print( "redraw: " );
+    Serial.print( s_segment_count + 1 );
+    Serial.print( " segments, spans " );
+    Serial.print( redraw );
+    Serial.print( " us, dot replay " );
+    Serial.print( replay );
+    Serial.println( " us" );
+}
+
+#endif // BENCHMARK_REDRAW
+
+
+void draw_snake()
+{
+    // when the view moves everything on screen moves with it
+    if( scroll_view() )
+    {
+        restore_board();
         return;
+    }
 
-    draw_dot( snake_erase.x, snake_erase.y, ST77XX_BLACK );
+    // the head can move several pixels per tick, so draw everything it passed over
+    draw_span( s_drawn_x, s_drawn_y, snake_draw.x, snake_draw.y, ST77XX_GREEN );
+    s_drawn_x = snake_draw.x;
+    s_drawn_y = snake_draw.y;
 }
 
 
@@ -418,20 +1057,27 @@ void move_snake()
 {
     if( s_paused )
         return;
-        
-    snake_draw.x += snake_draw.dir_x;
-    snake_draw.y += snake_draw.dir_y;
-    check_for_apple();
-    if( snake_in_segment() )
-        game_over();
-    
-    if( s_counter < snake_draw.length )
-        ++s_counter;
-    else
+
+    s_speed_frac += s_speed;
+    uint16_t steps = s_speed_frac >> kSpeedShift;
+    s_speed_frac  &= (1 << kSpeedShift) - 1;
+
+    if( steps )
     {
-        snake_erase.x += snake_erase.dir_x;
-        snake_erase.y += snake_erase.dir_y;
-        check_for_direction_change();
+        int16_t from_x = snake_draw.x;
+        int16_t from_y = snake_draw.y;
+        snake_draw.x += snake_draw.dir_x * steps;
+        snake_draw.y += snake_draw.dir_y * steps;
+        check_for_apple( from_x, from_y );
+
+        // the tail stays put until the snake has grown to its full length, move it before
+        // testing for collision since it would have kept pace with the head over this tick
+        uint16_t grow = min( steps, (uint16_t)(snake_draw.length - s_counter) );
+        s_counter += grow;
+        move_eraser( steps - grow );
+
+        if( snake_in_segment( from_x, from_y ) || level_in_path( from_x, from_y, snake_draw.x, snake_draw.y ) )
+            game_over();
     }
 
     boundary_clamp( &snake_draw );
@@ -440,13 +1086,47 @@ void move_snake()
 }
 
 
+void move_eraser( uint16_t steps )
+{
+    // a turn made right where the eraser stands (the head hadn't left it yet) comes first,
+    // or the eraser would carry on past it the old way
+    if( steps )
+        check_for_direction_change();
+
+    while( steps )
+    {
+        // never step over the next turn, the eraser has to land on it exactly
+        uint16_t run = steps;
+        if( s_segment_count )
+        {
+            Segment* turn = &s_segments[s_segment_reader];
+            uint16_t distance = abs( turn->x - snake_erase.x ) + abs( turn->y - snake_erase.y );
+            if( distance && distance < run )
+                run = distance;
+        }
+
+        int16_t from_x = snake_erase.x;
+        int16_t from_y = snake_erase.y;
+        snake_erase.x += snake_erase.dir_x * run;
+        snake_erase.y += snake_erase.dir_y * run;
+        s_tail_from_x  = snake_erase.x - snake_erase.dir_x;
+        s_tail_from_y  = snake_erase.y - snake_erase.dir_y;
+        draw_span( from_x, from_y, snake_erase.x, snake_erase.y, ST77XX_BLACK );
+        check_for_direction_change();
+        steps -= run;
+        s_tail_moving = true;
+    }
+}
+
+
 void draw_segments()
 {
     for( int i = 0; i < s_segment_count; i++ )
     {
         // first segment is at reader index
         int index = (s_segment_reader + i) % kMaxSegments;
-        tft.drawLine( s_segments[index].start_x, s_segments[index].start_y, s_segments[index].x, s_segments[index].y, ST77XX_WHITE );
+        tft.drawLine( s_segments[index].start_x * kCellSize - view_left(), s_segments[index].start_y * kCellSize - view_top(), 
+                      s_segments[index].x * kCellSize - view_left(), s_segments[index].y * kCellSize - view_top(), ST77XX_WHITE );
     }
     draw_dot( snake_draw.x, snake_draw.y, ST77XX_BLUE );
     draw_dot( snake_erase.x, snake_erase.y, ST77XX_RED );
@@ -482,14 +1162,20 @@ void dump_segments()
 }
 
 
-bool snake_in_segment()
+bool snake_in_segment( int16_t from_x, int16_t from_y )
 {
+    // sweep the path the head took this tick, not including where it started
+    int16_t min_x = min( (int16_t)(from_x + snake_draw.dir_x), (int16_t)snake_draw.x );
+    int16_t max_x = max( (int16_t)(from_x + snake_draw.dir_x), (int16_t)snake_draw.x );
+    int16_t min_y = min( (int16_t)(from_y + snake_draw.dir_y), (int16_t)snake_draw.y );
+    int16_t max_y = max( (int16_t)(from_y + snake_draw.dir_y), (int16_t)snake_draw.y );
+
     // go thru all the segments and see if we intersect any
     for( int i = 0; i < s_segment_count; i++ )
     {
         // first segment is at reader index
         int index = (s_segment_reader + i) % kMaxSegments;
-        if( dot_in_segment( snake_draw.x, snake_draw.y, &s_segments[index], 0 ) )
+        if( span_in_segment( min_x, min_y, max_x, max_y, &s_segments[index] ) )
         {
 #ifdef KEEP_DISPLAY_FOR_DEBUG
             Serial.print( "snake_in_segment: " ); 
@@ -546,29 +1232,40 @@ void erase_apple()
 
 void place_apple()
 {
-    // erase the old one first
-    erase_apple();
-    
-    // make sure we never put an apple on top of the snake
+    // make sure we never put an apple on top of the snake, and keep it where the player can see it
+    int16_t left = view_left() / kCellSize;
+    int16_t top  = view_top() / kCellSize;
+    int16_t right  = min( (int16_t)(left + kScreenWidth / kCellSize), board_width() );
+    int16_t bottom = min( (int16_t)(top + kScreenHeight / kCellSize), board_height() );
     do
     {
-        apple_x = random( 0, kScreenWidth );
-        apple_y = random( 0, kScreenHeight );
-    } while( apple_in_segment() );
+        apple_x = random( left, right );
+        apple_y = random( top, bottom );
+    } while( apple_in_segment() || level_hit_dot( apple_x, apple_y ) );
     
     draw_apple();
 }
 
 
-void check_for_apple()
+void check_for_apple( int16_t from_x, int16_t from_y )
 {
-    // see if we hit an apple!
-    if( nearly_equals( apple_x, snake_draw.x, kLineWidth ) && nearly_equals( apple_y, snake_draw.y, kLineWidth ) )
+    // see if we hit an apple anywhere along the path the head took this tick
+    int16_t min_x = min( from_x, (int16_t)snake_draw.x ) - kAppleReach;
+    int16_t max_x = max( from_x, (int16_t)snake_draw.x ) + kAppleReach;
+    int16_t min_y = min( from_y, (int16_t)snake_draw.y ) - kAppleReach;
+    int16_t max_y = max( from_y, (int16_t)snake_draw.y ) + kAppleReach;
+    if( apple_x >= min_x && apple_x <= max_x && apple_y >= min_y && apple_y <= max_y )
     {
-        // make snake longer and the game faster and faster
+        // make snake longer and the game faster and faster, past kMinDelay we move further per tick instead
         if( s_delayTime > kMinDelay )
             --s_delayTime;
-        snake_draw.length += 20;
+        else if( s_speed < kMaxSpeed )
+            s_speed += kSpeedStep;
+        snake_draw.length += kAppleGrowth;
+
+        // the old apple overlaps the body, so put the snake back after erasing it
+        erase_apple();
+        redraw_snake();
         place_apple();
         ++s_score;
     }
@@ -582,7 +1279,11 @@ bool apple_in_segment()
     {
         // first segment is at reader index
         int index = (s_segment_reader + i) % kMaxSegments;
+#ifdef CELL_GRID
+        if( span_in_segment( apple_x, apple_y, apple_x, apple_y, &s_segments[index] ) )
+#else
         if( dot_in_segment( apple_x, apple_y, &s_segments[index], kLineTolerance ) )
+#endif
             return true;
     }
     
@@ -594,13 +1295,26 @@ bool apple_in_segment()
 
 void boundary_clamp( Segment* segment )
 {
-    if( segment->x < 0 || segment->y < 0 || segment->x >= kScreenWidth || segment->y >= kScreenHeight )
+    if( segment->x < 0 || segment->y < 0 || segment->x >= board_width() || segment->y >= board_height() )
         game_over();
 }
 
 
 void add_segment()
 {
+    // a turn pressed before the head has moved on replaces the one made there, so mashing the
+    // buttons can't fill the buffer
+    if( s_segment_count )
+    {
+        Segment* newest = &s_segments[(s_segment_writer + kMaxSegments - 1) % kMaxSegments];
+        if( newest->x == snake_draw.x && newest->y == snake_draw.y )
+        {
+            newest->dir_x = snake_draw.dir_x;
+            newest->dir_y = snake_draw.dir_y;
+            return;
+        }
+    }
+
     // take current position and create a new segment
     s_segments[s_segment_writer].x       = snake_draw.x;
     s_segments[s_segment_writer].y       = snake_draw.y;
@@ -643,7 +1357,8 @@ void check_for_direction_change()
     // see if we are standing on a direction change
     int index = s_segment_reader % kMaxSegments;
 
-    if( s_segments[index].x == snake_erase.x && s_segments[index].y == snake_erase.y )
+    // several turns can land on the same spot if more than one direction was pressed at once
+    while( s_segment_count && s_segments[index].x == snake_erase.x && s_segments[index].y == snake_erase.y )
     {
         // read the data and pop it off
         snake_erase.dir_x = s_segments[index].dir_x;
@@ -663,13 +1378,15 @@ void check_for_direction_change()
 
         if( s_segment_reader >= kMaxSegments )
             s_segment_reader = 0;  // wrap around to the front of the buffer
+        index = s_segment_reader;
     
 //        Serial.print( "pop- s_segment_count: " );
 //        Serial.print( s_segment_count );
 //        Serial.print( ", s_segment_reader: " );
 //        Serial.println( s_segment_reader );
     }
-    else
+
+    if( s_segment_count )
     {
         // update this segment to reflect its actual length...
         s_segments[index].start_x = snake_erase.x;
@@ -680,6 +1397,26 @@ void check_for_direction_change()
 
 #pragma mark -
 
+bool turning_back( int16_t dir_x, int16_t dir_y )
+{
+    // until the head leaves the spot of its last turn it is still on the end of the segment it came
+    // in on, so turning back along that segment runs straight into the body. With cells this spot
+    // lasts several ticks, enough for a second quick turn to get in.
+    for( int i = 0; i < s_segment_count; i++ )
+    {
+        // newest segment first, skipping any that turned again on the same spot
+        Segment* seg = &s_segments[(s_segment_writer + kMaxSegments - 1 - i) % kMaxSegments];
+        if( seg->x != snake_draw.x || seg->y != snake_draw.y )
+            return false;
+
+        if( seg->x != seg->start_x || seg->y != seg->start_y )
+            return dir_x == (seg->x < seg->start_x) - (seg->x > seg->start_x) && dir_y == (seg->y < seg->start_y) - (seg->y > seg->start_y);
+    }
+
+    return false;
+}
+
+
 void move_left()
 {
     // check to see if we are already moving in that direction
@@ -690,6 +1427,14 @@ void move_left()
     if( snake_draw.dir_x == -1 && snake_draw.dir_y == 0 )
         return;
 
+    // or back the way we just came in
+    if( turning_back( 1, 0 ) )
+        return;
+
+    // or when there is no room left to remember the turn
+    if( s_segment_count >= kMaxSegments )
+        return;
+
     snake_draw.dir_x = 1;
     snake_draw.dir_y = 0;
     add_segment();
@@ -706,6 +1451,14 @@ void move_right()
     if( snake_draw.dir_x == 1 && snake_draw.dir_y == 0 )
         return;
 
+    // or back the way we just came in
+    if( turning_back( -1, 0 ) )
+        return;
+
+    // or when there is no room left to remember the turn
+    if( s_segment_count >= kMaxSegments )
+        return;
+
     snake_draw.dir_x = -1;
     snake_draw.dir_y = 0;
     add_segment();
@@ -722,6 +1475,14 @@ void move_up()
     if( snake_draw.dir_x == 0 && snake_draw.dir_y == -1 )
         return;
 
+    // or back the way we just came in
+    if( turning_back( 0, 1 ) )
+        return;
+
+    // or when there is no room left to remember the turn
+    if( s_segment_count >= kMaxSegments )
+        return;
+
     snake_draw.dir_x = 0;
     snake_draw.dir_y = 1;
     add_segment();
@@ -738,6 +1499,14 @@ void move_down()
     if( snake_draw.dir_x == 0 && snake_draw.dir_y == 1 )
         return;
 
+    // or back the way we just came in
+    if( turning_back( 0, -1 ) )
+        return;
+
+    // or when there is no room left to remember the turn
+    if( s_segment_count >= kMaxSegments )
+        return;
+
     snake_draw.dir_x = 0;
     snake_draw.dir_y = -1;
     add_segment();
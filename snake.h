@@ -45,10 +45,16 @@
 
 
 bool initialize_graphics();
+bool mount_storage();
+void service_storage();
+void boot_mark( const char* phase );
 Adafruit_ST7735* get_tft();
+uint16_t get_cell_size();
+uint16_t get_board_memory();
 
-void draw_intro();
+void draw_intro( bool (*skip)() );
 void start_game();
+bool load_level( uint8_t level );
 void draw_snake();
 void move_snake();
 void move_left();
@@ -56,6 +62,7 @@ void move_right();
 void move_up();
 void move_down();
 void pause();
+void restore_board();
 
 
 #endif /* snake_h */
@@ -0,0 +1,58 @@
+//
+//  snake_rules.h
+//  
+//
+//  The numbers behind the rules of the game, shared by snake.cpp and the batched engine
+//  in host/ so the two can't drift apart.
+//
+
+#ifndef snake_rules_h
+#define snake_rules_h
+
+#include <stdint.h>
+
+
+// Board coordinates are pixels, or with CELL_GRID cells of kCellSize pixels. Cells make
+// collision and apple pickup exact and let the board state fit in bytes.
+#ifdef CELL_GRID
+  #define kCellSize      4
+  #define kAppleReach    0                      // the head has to be on the apple's cell
+  #define kTurnCell      1                      // a segment's turn cell is part of its body
+  #define kMaxCoord      INT8_MAX
+  typedef int8_t coord_t;
+#else
+  #define kCellSize      1
+  #define kAppleReach    kLineWidth
+  #define kTurnCell      0
+  #define kMaxCoord      INT16_MAX
+  typedef int16_t coord_t;
+#endif
+
+#define kPanelWidth    160                      // the mini TFT in landscape
+#define kPanelHeight   80
+
+#define kStartDelay    40                       // ms per tick, this gets shorter as the levels get higher
+#define kMinDelay      20                       // 50 ticks a second at most, past this the snake speeds up instead
+#define kSpeedShift    8                        // speeds are fixed point board units per tick
+#define kStartSpeed    ((1 << kSpeedShift) / kCellSize)
+#define kMaxSpeed      ((8 << kSpeedShift) / kCellSize)
+#define kSpeedStep     ((1 << (kSpeedShift - 2)) / kCellSize)  // 1/4 of a pixel per tick for every apple past kMinDelay
+#define kLineWidth     3             
+#define kLineTolerance (kLineWidth + 2)   // line width is 3 plus one pixel on each side
+#define kMaxSegments  100
+#define kScrollMargin    16          // in pixels, the view moves once the head gets this close to the edge of the screen
+#define kStartingPointX  (80 / kCellSize)
+#define kStartingPointY  (40 / kCellSize)
+#define kStartLength     ((10 + kCellSize - 1) / kCellSize)
+#define kAppleGrowth     (20 / kCellSize)
+
+
+// a level has to be whole cells and small enough for coord_t once it is in board units
+static inline bool level_fits( uint8_t tile, uint16_t width, uint16_t height )
+{
+    return tile && width && height && !(tile % kCellSize) &&
+           (uint32_t)width * tile / kCellSize <= kMaxCoord && (uint32_t)height * tile / kCellSize <= kMaxCoord;
+}
+
+
+#endif /* snake_rules_h */